@@ -7,11 +7,13 @@
 #include "p3a_for_each.hpp"
 
 #include "dgt_amr.hpp"
+#include "dgt_dispatch.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_interp.hpp"
 #include "dgt_marks.hpp"
 #include "dgt_mesh.hpp"
 #include "dgt_spatial.hpp"
+#include "dgt_tensor.hpp"
 
 namespace dgt {
 
@@ -163,7 +165,8 @@ void do_insertion(
   p3a::for_each(p3a::execution::par, generalize(from_subgrid), f);
 }
 
-void do_prolongation(
+template <class O>
+static void do_prolongation(
     Basis const& b,
     View<double***> from,
     View<double***> to,
@@ -171,39 +174,65 @@ void do_prolongation(
     p3a::grid3 const& to_grid,
     p3a::subgrid3 const& from_subgrid,
     p3a::subgrid3 const& to_subgrid) {
-  CALI_CXX_MARK_FUNCTION;
-  verify_transfer(b, from, to, from_grid, to_grid, from_subgrid, to_subgrid);
   int const neq = from.extent(1);
-  int const nchild = num_child(b.dim);
-  int const nintr_pts = num_pts(b.dim, b.p);
+  int const nchild = O::nchild;
+  int const nintr_pts = O::nintr_pts;
+  BasisTable const bt = b.table;
   p3a::grid3 const general_from_grid = generalize(from_grid);
   p3a::grid3 const general_to_grid = generalize(to_grid);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& from_cell_ijk) {
-    int const from_cell = general_from_grid.index(from_cell_ijk);
-    p3a::vector3<int> const coarse_offset = from_cell_ijk - from_subgrid.lower();
-    for (int child = 0; child < nchild; ++child) {
-      p3a::vector3<int> const local = get_local(child);
-      p3a::vector3<int> const fine_offset = get_fine_ijk(coarse_offset, local);
-      p3a::vector3<int> const to_cell_ijk = to_subgrid.lower() + fine_offset;
-      int const to_cell = general_to_grid.index(to_cell_ijk);
-      for (int pt = 0; pt < nintr_pts; ++pt) {
-        double const wt = b.wt_intr(pt);
-        for (int m = 0; m < b.nmodes; ++m) {
-          double const phi = b.phi_intr(pt, m);
-          double const mass = b.mass(m);
-          for (int eq = 0; eq < neq; ++eq) {
-            double const from_eq = interp_scalar_child_intr(
-                from, b, from_cell, child, pt, eq);
-            to(to_cell, eq, m) += from_eq * phi * wt / mass;
+  if constexpr (O::tensor) {
+    auto f = [=] P3A_DEVICE (p3a::vector3<int> const& from_cell_ijk) {
+      double vals[O::nintr_pts];
+      double r[O::nmodes];
+      int const from_cell = general_from_grid.index(from_cell_ijk);
+      p3a::vector3<int> const coarse_offset = from_cell_ijk - from_subgrid.lower();
+      for (int child = 0; child < nchild; ++child) {
+        p3a::vector3<int> const local = get_local(child);
+        p3a::vector3<int> const fine_offset = get_fine_ijk(coarse_offset, local);
+        p3a::vector3<int> const to_cell_ijk = to_subgrid.lower() + fine_offset;
+        int const to_cell = general_to_grid.index(to_cell_ijk);
+        for (int eq = 0; eq < neq; ++eq) {
+          tensor_interp_child_intr<O>(from, bt, from_cell, local, eq, vals);
+          for (int pt = 0; pt < nintr_pts; ++pt) {
+            vals[pt] *= bt.wt_intr(pt);
+          }
+          tensor_integrate_intr<O>(bt, -1, vals, r);
+          for (int t = 0; t < O::nmodes; ++t) {
+            int const m = bt.tensor_mode(t);
+            to(to_cell, eq, m) += r[t] / bt.mass(m);
           }
         }
       }
-    }
-  };
-  p3a::for_each(p3a::execution::par, generalize(from_subgrid), f);
+    };
+    p3a::for_each(p3a::execution::par, generalize(from_subgrid), f);
+  } else {
+    auto f = [=] P3A_DEVICE (p3a::vector3<int> const& from_cell_ijk) {
+      int const from_cell = general_from_grid.index(from_cell_ijk);
+      p3a::vector3<int> const coarse_offset = from_cell_ijk - from_subgrid.lower();
+      for (int child = 0; child < nchild; ++child) {
+        p3a::vector3<int> const local = get_local(child);
+        p3a::vector3<int> const fine_offset = get_fine_ijk(coarse_offset, local);
+        p3a::vector3<int> const to_cell_ijk = to_subgrid.lower() + fine_offset;
+        int const to_cell = general_to_grid.index(to_cell_ijk);
+        for (int pt = 0; pt < nintr_pts; ++pt) {
+          double const wt = bt.wt_intr(pt);
+          for (int m = 0; m < O::nmodes; ++m) {
+            double const phi = bt.phi_intr(pt, m);
+            double const mass = bt.mass(m);
+            for (int eq = 0; eq < neq; ++eq) {
+              double const from_eq = interp_scalar_child_intr<O::nmodes>(
+                  from, bt, from_cell, child, pt, eq);
+              to(to_cell, eq, m) += from_eq * phi * wt / mass;
+            }
+          }
+        }
+      }
+    };
+    p3a::for_each(p3a::execution::par, generalize(from_subgrid), f);
+  }
 }
 
-void do_restriction(
+void do_prolongation(
     Basis const& b,
     View<double***> from,
     View<double***> to,
@@ -212,13 +241,30 @@ void do_restriction(
     p3a::subgrid3 const& from_subgrid,
     p3a::subgrid3 const& to_subgrid) {
   CALI_CXX_MARK_FUNCTION;
-  verify_transfer(b, from, to, from_grid, to_grid, to_subgrid, from_subgrid);
+  verify_transfer(b, from, to, from_grid, to_grid, from_subgrid, to_subgrid);
+  auto f = [&] (auto order) {
+    do_prolongation<decltype(order)>(
+        b, from, to, from_grid, to_grid, from_subgrid, to_subgrid);
+  };
+  dispatch(b, f);
+}
+
+template <class O>
+static void do_restriction(
+    Basis const& b,
+    View<double***> from,
+    View<double***> to,
+    p3a::grid3 const& from_grid,
+    p3a::grid3 const& to_grid,
+    p3a::subgrid3 const& from_subgrid,
+    p3a::subgrid3 const& to_subgrid) {
   int const neq = from.extent(1);
-  int const nchild = num_child(b.dim);
-  int const nintr_pts = num_pts(b.dim, b.p);
+  int const nchild = O::nchild;
+  int const nintr_pts = O::nintr_pts;
+  BasisTable const bt = b.table;
   p3a::grid3 const general_from_grid = generalize(from_grid);
   p3a::grid3 const general_to_grid = generalize(to_grid);
-  double const factor = std::pow(0.5, b.dim);
+  double const factor = std::pow(0.5, O::dim);
   auto f = [=] P3A_DEVICE (p3a::vector3<int> const& to_cell_ijk) {
     int const to_cell = general_to_grid.index(to_cell_ijk);
     p3a::vector3<int> const coarse_offset = to_cell_ijk - to_subgrid.lower();
@@ -228,13 +274,13 @@ void do_restriction(
       p3a::vector3<int> const from_cell_ijk = from_subgrid.lower() + fine_offset;
       int const from_cell = general_from_grid.index(from_cell_ijk);
       for (int pt = 0; pt < nintr_pts; ++pt) {
-        double const wt = b.wt_intr(pt);
-        for (int m = 0; m < b.nmodes; ++m) {
-          double const phi = b.phi_child_intr(child, pt, m);
-          double const mass = b.mass(m);
+        double const wt = bt.wt_intr(pt);
+        for (int m = 0; m < O::nmodes; ++m) {
+          double const phi = bt.phi_child_intr(child, pt, m);
+          double const mass = bt.mass(m);
           for (int eq = 0; eq < neq; ++eq) {
-            double const from_eq = interp_scalar_intr(
-                from, b, from_cell, pt, eq);
+            double const from_eq = interp_scalar_intr<O::nmodes>(
+                from, bt, from_cell, pt, eq);
             to(to_cell, eq, m) += factor * from_eq * phi * wt / mass;
           }
         }
@@ -244,6 +290,23 @@ void do_restriction(
   p3a::for_each(p3a::execution::par, generalize(to_subgrid), f);
 }
 
+void do_restriction(
+    Basis const& b,
+    View<double***> from,
+    View<double***> to,
+    p3a::grid3 const& from_grid,
+    p3a::grid3 const& to_grid,
+    p3a::subgrid3 const& from_subgrid,
+    p3a::subgrid3 const& to_subgrid) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_transfer(b, from, to, from_grid, to_grid, to_subgrid, from_subgrid);
+  auto f = [&] (auto order) {
+    do_restriction<decltype(order)>(
+        b, from, to, from_grid, to_grid, from_subgrid, to_subgrid);
+  };
+  dispatch(b, f);
+}
+
 static Tree copy_tree(
     Tree const& tree,
     std::vector<Node*> const& leaves) {
@@ -830,6 +893,7 @@ void modify(Mesh& mesh, std::vector<int8_t> const& in_marks) {
   mesh.rebuild();
   mesh.clean();
   cleanup(mesh);
+  mesh.repack();
 }
 
 }
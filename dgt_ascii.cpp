@@ -1,11 +1,15 @@
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <stdexcept>
 
 #include "caliper/cali.h"
 
 #include "dgt_file.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_mesh.hpp"
+#include "dgt_output.hpp"
 
 namespace dgt {
 
@@ -25,6 +29,14 @@ static void verify_file(
   }
 }
 
+static void verify_stream(
+    std::fstream const& f,
+    std::filesystem::path const& path) {
+  if (!f) {
+    throw std::runtime_error("ascii - corrupt file: " + path.string());
+  }
+}
+
 template <class T>
 void write_vec3(std::stringstream& stream, p3a::vector3<T> const& v) {
   stream << v.x() << " " << v.y() << " " << v.z();
@@ -35,6 +47,22 @@ static void write_point(std::stringstream& stream, Point const& pt) {
   write_vec3(stream, pt.ijk);
 }
 
+static std::string get_block_name(Point const& pt) {
+  std::stringstream stream;
+  stream << pt.depth << "_";
+  stream << pt.ijk.x() << "_" << pt.ijk.y() << "_" << pt.ijk.z();
+  stream << ".dga";
+  return stream.str();
+}
+
+static std::filesystem::path get_block_path(
+    std::filesystem::path const& base,
+    Block const& block) {
+  std::filesystem::path const path = base / get_block_name(block.node()->pt());
+  if (std::filesystem::exists(path)) return path;
+  return base / (std::to_string(block.id()) + ".dga");
+}
+
 static void write_meta(std::filesystem::path const& base, Mesh const& mesh) {
   CALI_CXX_MARK_FUNCTION;
   std::stringstream stream;
@@ -65,93 +93,217 @@ static void write_meta(std::filesystem::path const& base, Mesh const& mesh) {
   write_stream(file_path, stream);
 }
 
-static void read_meta(std::filesystem::path const& path, Mesh& mesh) {
-  CALI_CXX_MARK_FUNCTION;
-  std::filesystem::path const file_path = path / "mesh.dga";
-  std::fstream file;
-  file.open(file_path, std::ios::in);
-  verify_file(file, file_path);
+struct Meta {
+  int dim;
+  int p;
   bool tensor;
-  int dim, p, nsoln, nmodal_eq, nflux_eq, nblocks, nfields;
-  p3a::vector3<double> xmin, xmax;
+  int nsoln;
+  int nmodal_eq;
+  int nflux_eq;
+  p3a::vector3<double> xmin;
+  p3a::vector3<double> xmax;
   p3a::vector3<bool> periodic;
   p3a::vector3<int> cells;
   Point base;
   std::vector<Point> leaf_pts;
+  std::vector<std::uint8_t> tree_bits;
   std::vector<FieldInfo> fields;
-  file >> dim;
-  file >> p;
-  file >> tensor;
-  file >> nsoln;
-  file >> nmodal_eq;
-  file >> nflux_eq;
-  file >> xmin.x() >> xmin.y() >> xmin.z();
-  file >> xmax.x() >> xmax.y() >> xmax.z();
-  file >> periodic.x() >> periodic.y() >> periodic.z();
-  file >> cells.x() >> cells.y() >> cells.z();
-  file >> base.depth >> base.ijk.x() >> base.ijk.y() >> base.ijk.z();
+};
+
+static void parse_meta(std::filesystem::path const& path, Meta& meta) {
+  CALI_CXX_MARK_FUNCTION;
+  std::filesystem::path const file_path = path / "mesh.dga";
+  std::fstream file;
+  file.open(file_path, std::ios::in);
+  verify_file(file, file_path);
+  int nblocks = 0;
+  int nfields = 0;
+  file >> meta.dim;
+  file >> meta.p;
+  file >> meta.tensor;
+  file >> meta.nsoln;
+  file >> meta.nmodal_eq;
+  file >> meta.nflux_eq;
+  file >> meta.xmin.x() >> meta.xmin.y() >> meta.xmin.z();
+  file >> meta.xmax.x() >> meta.xmax.y() >> meta.xmax.z();
+  file >> meta.periodic.x() >> meta.periodic.y() >> meta.periodic.z();
+  file >> meta.cells.x() >> meta.cells.y() >> meta.cells.z();
+  file >> meta.base.depth >> meta.base.ijk.x() >> meta.base.ijk.y() >> meta.base.ijk.z();
   file >> nblocks;
-  leaf_pts.resize(nblocks);
-  for (Point& pt : leaf_pts) {
+  verify_stream(file, file_path);
+  meta.leaf_pts.resize(nblocks);
+  for (Point& pt : meta.leaf_pts) {
     file >> pt.depth >> pt.ijk.x() >> pt.ijk.y() >> pt.ijk.z();
   }
   file >> nfields;
-  fields.resize(nfields);
-  for (FieldInfo& field : fields) {
+  verify_stream(file, file_path);
+  meta.fields.resize(nfields);
+  for (FieldInfo& field : meta.fields) {
     file >> std::quoted(field.name);
     file >> field.ent_dim;
     file >> field.ncomps;
   }
+  verify_stream(file, file_path);
   file.close();
-  mesh.set_domain({xmin, xmax});
-  mesh.set_periodic(periodic);
-  mesh.set_cell_grid(cells);
-  mesh.set_nsoln(nsoln);
-  mesh.set_nmodal_eq(nmodal_eq);
-  mesh.set_nflux_eq(nflux_eq);
-  mesh.init(p3a::grid3(base.ijk), p, tensor);
-  for (Point& pt : leaf_pts) {
-    mesh.tree().insert(pt);
-  }
-  for (FieldInfo& field : fields) {
+}
+
+template <class T>
+static void pack(std::vector<char>& buf, T const& value) {
+  char const* bytes = reinterpret_cast<char const*>(&value);
+  buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+static void unpack(std::vector<char> const& buf, std::size_t& pos, T& value) {
+  std::memcpy(&value, buf.data() + pos, sizeof(T));
+  pos += sizeof(T);
+}
+
+static std::vector<char> pack_meta(Meta const& meta) {
+  std::vector<char> buf;
+  pack(buf, meta.dim);
+  pack(buf, meta.p);
+  pack(buf, meta.tensor);
+  pack(buf, meta.nsoln);
+  pack(buf, meta.nmodal_eq);
+  pack(buf, meta.nflux_eq);
+  pack(buf, meta.xmin);
+  pack(buf, meta.xmax);
+  pack(buf, meta.periodic);
+  pack(buf, meta.cells);
+  pack(buf, meta.base);
+  pack(buf, int(meta.tree_bits.size()));
+  buf.insert(buf.end(), meta.tree_bits.begin(), meta.tree_bits.end());
+  pack(buf, int(meta.fields.size()));
+  for (FieldInfo const& field : meta.fields) {
+    pack(buf, int(field.name.size()));
+    buf.insert(buf.end(), field.name.begin(), field.name.end());
+    pack(buf, field.ent_dim);
+    pack(buf, field.ncomps);
+  }
+  return buf;
+}
+
+static void unpack_meta(std::vector<char> const& buf, Meta& meta) {
+  std::size_t pos = 0;
+  int nbits, nfields;
+  unpack(buf, pos, meta.dim);
+  unpack(buf, pos, meta.p);
+  unpack(buf, pos, meta.tensor);
+  unpack(buf, pos, meta.nsoln);
+  unpack(buf, pos, meta.nmodal_eq);
+  unpack(buf, pos, meta.nflux_eq);
+  unpack(buf, pos, meta.xmin);
+  unpack(buf, pos, meta.xmax);
+  unpack(buf, pos, meta.periodic);
+  unpack(buf, pos, meta.cells);
+  unpack(buf, pos, meta.base);
+  unpack(buf, pos, nbits);
+  meta.tree_bits.assign(buf.data() + pos, buf.data() + pos + nbits);
+  pos += nbits;
+  unpack(buf, pos, nfields);
+  meta.fields.resize(nfields);
+  for (FieldInfo& field : meta.fields) {
+    int name_size;
+    unpack(buf, pos, name_size);
+    field.name.assign(buf.data() + pos, name_size);
+    pos += name_size;
+    unpack(buf, pos, field.ent_dim);
+    unpack(buf, pos, field.ncomps);
+  }
+}
+
+static void init_mesh(Meta const& meta, Mesh& mesh) {
+  mesh.set_domain({meta.xmin, meta.xmax});
+  mesh.set_periodic(meta.periodic);
+  mesh.set_cell_grid(meta.cells);
+  mesh.set_nsoln(meta.nsoln);
+  mesh.set_nmodal_eq(meta.nmodal_eq);
+  mesh.set_nflux_eq(meta.nflux_eq);
+  mesh.init(p3a::grid3(meta.base.ijk), meta.p, meta.tensor);
+}
+
+static void read_meta(std::filesystem::path const& path, Mesh& mesh) {
+  CALI_CXX_MARK_FUNCTION;
+  Meta meta;
+  mpicpp::comm* comm = mesh.comm();
+  std::vector<char> buf;
+  int status = 0;
+  if (comm->rank() == 0) {
+    try {
+      parse_meta(path, meta);
+      init_mesh(meta, mesh);
+      for (Point const& pt : meta.leaf_pts) {
+        mesh.tree().insert(pt);
+      }
+      meta.tree_bits = encode_tree(mesh.tree());
+      buf = pack_meta(meta);
+    } catch (std::exception const& e) {
+      std::string const what = e.what();
+      status = 1;
+      buf.assign(what.begin(), what.end());
+    }
+  }
+  std::uint64_t size = buf.size();
+  MPI_Bcast(&status, 1, MPI_INT, 0, comm->get());
+  MPI_Bcast(&size, 1, MPI_UINT64_T, 0, comm->get());
+  buf.resize(size);
+  MPI_Bcast(buf.data(), int(size), MPI_CHAR, 0, comm->get());
+  if (status) {
+    throw std::runtime_error(std::string(buf.begin(), buf.end()));
+  }
+  if (comm->rank() != 0) {
+    unpack_meta(buf, meta);
+    init_mesh(meta, mesh);
+    decode_tree(mesh.tree(), meta.tree_bits);
+  }
+  for (FieldInfo const& field : meta.fields) {
     mesh.add_field(field.name, field.ent_dim, field.ncomps);
   }
   mesh.rebuild();
   mesh.allocate();
 }
 
-static void write_block(std::filesystem::path const& base, Block const& block) {
+static void write_block_data(
+    std::filesystem::path const& file_path,
+    p3a::grid3 const& cell_grid,
+    HView<double***> U_host) {
   CALI_CXX_MARK_FUNCTION;
   std::stringstream stream;
   stream << std::scientific;
   stream << std::setprecision(17);
-  p3a::grid3 const cell_grid = generalize(block.cell_grid());
-  View<double***> U = block.soln(0);
-  auto U_host = Kokkos::create_mirror_view(U);
-  Kokkos::deep_copy(U_host, U);
-  Basis const b = block.basis();
-  int const neq = U.extent(1);
+  int const neq = U_host.extent(1);
+  int const nmodes = U_host.extent(2);
   auto f = [&] (p3a::vector3<int> const& cell_ijk) {
     int const cell = cell_grid.index(cell_ijk);
     for (int eq = 0; eq < neq; ++eq) {
-      for (int m = 0; m < b.nmodes; ++m) {
+      for (int m = 0; m < nmodes; ++m) {
         stream << std::setw(24) << U_host(cell, eq, m) << " ";
       }
       stream << "\n";
     }
   };
   p3a::for_each(p3a::execution::seq, cell_grid, f);
-  int const id = block.id();
-  std::string const block_name = std::to_string(id) + ".dga";
-  std::filesystem::path const file_path = base / block_name;
   write_stream(file_path, stream);
 }
 
+static HView<double***> snapshot_block(Block const& block) {
+  View<double***> U = block.soln(0);
+  HView<double***> U_host("dgt::ascii::U_host", U.extent(0), U.extent(1), U.extent(2));
+  Kokkos::deep_copy(U_host, U);
+  return U_host;
+}
+
+static void write_block(std::filesystem::path const& base, Block const& block) {
+  CALI_CXX_MARK_FUNCTION;
+  p3a::grid3 const cell_grid = generalize(block.cell_grid());
+  std::string const block_name = get_block_name(block.node()->pt());
+  write_block_data(base / block_name, cell_grid, snapshot_block(block));
+}
+
 static void read_block(std::filesystem::path const& base, Block& block) {
   CALI_CXX_MARK_FUNCTION;
-  int const id = block.id();
-  std::string const block_name = std::to_string(id) + ".dga";
-  std::filesystem::path const file_path = base / block_name;
+  std::filesystem::path const file_path = get_block_path(base, block);
   std::fstream file;
   file.open(file_path, std::ios::in);
   verify_file(file, file_path);
@@ -185,6 +337,31 @@ void write_mesh(std::filesystem::path const& path, Mesh const& mesh) {
   }
 }
 
+void write_mesh(
+    OutputQueue& queue,
+    std::filesystem::path const& path,
+    Mesh const& mesh) {
+  CALI_CXX_MARK_FUNCTION;
+  std::filesystem::path const base(path.string() + ".dga");
+  std::filesystem::create_directory(base);
+  if (mesh.comm()->rank() == 0) {
+    write_meta(base, mesh);
+  }
+  p3a::grid3 const cell_grid = generalize(mesh.cell_grid());
+  std::vector<std::filesystem::path> paths;
+  std::vector<HView<double***>> solns;
+  for (Node* leaf : mesh.owned_leaves()) {
+    paths.push_back(base / get_block_name(leaf->pt()));
+    solns.push_back(snapshot_block(leaf->block));
+  }
+  auto job = [=] () {
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      write_block_data(paths[i], cell_grid, solns[i]);
+    }
+  };
+  queue.push(job);
+}
+
 void read_mesh(std::filesystem::path const& path, Mesh& mesh) {
   CALI_CXX_MARK_FUNCTION;
   verify_extension(path);
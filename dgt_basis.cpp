@@ -1,5 +1,8 @@
+#include <array>
 #include <cmath>
 #include <limits>
+#include <map>
+#include <mutex>
 
 #include "caliper/cali.h"
 
@@ -467,6 +470,106 @@ static HView<double*> get_mass(int dim, int p, bool tensor) {
   return mass;
 }
 
+static HView<int*> get_tensor_mode(int dim, int p, bool tensor) {
+  HView<int*> tmodes("", num_tensor_modes(dim, p));
+  Kokkos::deep_copy(tmodes, -1);
+  int m = 0;
+  p3a::vector3<int> const bounds = tensor_bounds(dim, p);
+  for (int block = 0; block < p+1; ++block) {
+    for (int deg = 0; deg < dim*p + 1; ++deg) {
+      for (int k = 0; k < bounds.z(); ++k) {
+        for (int j = 0; j < bounds.y(); ++j) {
+          for (int i = 0; i < bounds.x(); ++i) {
+            int const sum = i+j+k;
+            int const idx = p3a::max(i, p3a::max(j, k));
+            if ((!tensor) && (sum > p)) continue;
+            if ((idx == block) && (sum == deg)) {
+              tmodes(index({i,j,k}, bounds)) = m;
+              m++;
+            }
+          }
+        }
+      }
+    }
+  }
+  return tmodes;
+}
+
+static HView<double**> get_phi_1d(int p, int deriv) {
+  HView<double**> phi("", p+1, p+1);
+  for (int pt = 0; pt < p+1; ++pt) {
+    for (int deg = 0; deg < p+1; ++deg) {
+      phi(pt, deg) = legendre(deg, deriv, gauss_pt(p, pt));
+    }
+  }
+  return phi;
+}
+
+static HView<double***> get_phi_child_1d(int p) {
+  HView<double***> phi("", ndirs, p+1, p+1);
+  double const x[3] = {-1., 0., 1.};
+  for (int which_child = 0; which_child < ndirs; ++which_child) {
+    for (int pt = 0; pt < p+1; ++pt) {
+      double const xi = shift(gauss_pt(p, pt), x[which_child], x[which_child + 1]);
+      for (int deg = 0; deg < p+1; ++deg) {
+        phi(which_child, pt, deg) = legendre(deg, 0, xi);
+      }
+    }
+  }
+  return phi;
+}
+
+static HView<double**> get_phi_side_1d(int p) {
+  HView<double**> phi("", ndirs, p+1);
+  for (int dir = 0; dir < ndirs; ++dir) {
+    for (int deg = 0; deg < p+1; ++deg) {
+      phi(dir, deg) = legendre(deg, 0, get_dir_sign(dir));
+    }
+  }
+  return phi;
+}
+
+void BasisTable::init(int dim, int p, bool tensor) {
+  verify_dim(dim);
+  verify_p(p);
+  m_dim = dim;
+  m_p = p;
+  m_nmodes = num_modes(dim, p, tensor);
+  HView<int*> const tmodes = get_tensor_mode(dim, p, tensor);
+  p3a::vector3<int> const bounds = tensor_bounds(dim, p);
+  for (int t = 0; t < num_tensor_modes(dim, p); ++t) {
+    int const m = tmodes(t);
+    m_tensor_mode[t] = m;
+    if (m < 0) continue;
+    m_mode_deg[m][X] = t % bounds.x();
+    m_mode_deg[m][Y] = (t / bounds.x()) % bounds.y();
+    m_mode_deg[m][Z] = t / (bounds.x() * bounds.y());
+  }
+  HView<double**> const phi = get_phi_1d(p, 0);
+  HView<double**> const dphi = get_phi_1d(p, 1);
+  HView<double***> const phi_child = get_phi_child_1d(p);
+  HView<double**> const phi_side = get_phi_side_1d(p);
+  for (int pt = 0; pt < p+1; ++pt) {
+    m_wt_1d[pt] = gauss_wt(p, pt);
+    for (int deg = 0; deg < p+1; ++deg) {
+      m_phi_1d[pt][deg] = phi(pt, deg);
+      m_dphi_1d[pt][deg] = dphi(pt, deg);
+      for (int dir = 0; dir < ndirs; ++dir) {
+        m_phi_child_1d[dir][pt][deg] = phi_child(dir, pt, deg);
+      }
+    }
+  }
+  for (int dir = 0; dir < ndirs; ++dir) {
+    for (int deg = 0; deg < p+1; ++deg) {
+      m_phi_side_1d[dir][deg] = phi_side(dir, deg);
+    }
+  }
+  HView<double*> const mass = get_mass(dim, p, tensor);
+  for (int m = 0; m < m_nmodes; ++m) {
+    m_mass[m] = mass(m);
+  }
+}
+
 void Basis::init(int in_dim, int in_p, bool tensor_in) {
   CALI_CXX_MARK_FUNCTION;
   verify_dim(in_dim);
@@ -506,6 +609,12 @@ void Basis::init(int in_dim, int in_p, bool tensor_in) {
   copy(get_phi_corner(dim, p, tensor), phi_corner);
   copy(get_phi_corner2(dim, p, tensor), phi_corner2);
   copy(get_mass(dim, p, tensor), mass);
+  copy(get_tensor_mode(dim, p, tensor), tensor_mode);
+  copy(get_phi_1d(p, 0), phi_1d);
+  copy(get_phi_1d(p, 1), dphi_1d);
+  copy(get_phi_child_1d(p), phi_child_1d);
+  copy(get_phi_side_1d(p), phi_side_1d);
+  table.init(dim, p, tensor);
 }
 
 void HostBasis::init(int in_dim, int in_p, bool tensor_in) {
@@ -547,6 +656,37 @@ void HostBasis::init(int in_dim, int in_p, bool tensor_in) {
   phi_corner = get_phi_corner(dim, p, tensor);
   phi_corner2 = get_phi_corner2(dim, p, tensor);
   mass = get_mass(dim, p, tensor);
+  tensor_mode = get_tensor_mode(dim, p, tensor);
+  phi_1d = get_phi_1d(p, 0);
+  dphi_1d = get_phi_1d(p, 1);
+  phi_child_1d = get_phi_child_1d(p);
+  phi_side_1d = get_phi_side_1d(p);
+  table.init(dim, p, tensor);
+}
+
+using BasisKey = std::array<int, 3>;
+
+static std::mutex basis_cache_mutex;
+static std::map<BasisKey, Basis> basis_cache;
+
+Basis const& get_basis(int dim, int p, bool tensor) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_dim(dim);
+  verify_p(p);
+  BasisKey const key = {dim, p, int(tensor)};
+  std::lock_guard<std::mutex> lock(basis_cache_mutex);
+  auto it = basis_cache.find(key);
+  if (it == basis_cache.end()) {
+    Basis basis;
+    basis.init(dim, p, tensor);
+    it = basis_cache.emplace(key, basis).first;
+  }
+  return it->second;
+}
+
+void clear_basis_cache() {
+  std::lock_guard<std::mutex> lock(basis_cache_mutex);
+  basis_cache.clear();
 }
 
 static std::string mode_comp_name(int axis, int p) {
@@ -10,6 +10,115 @@ namespace dgt {
 
 static constexpr int max_q = 3;
 static constexpr int max_p = 2;
+static constexpr int max_n = max_p + 1;
+static constexpr int max_modes = max_n * max_n * max_n;
+
+class BasisTable {
+  private:
+    int m_dim = -1;
+    int m_p = -1;
+    int m_nmodes = -1;
+    int m_mode_deg[max_modes][DIMS] = {};
+    int m_tensor_mode[max_modes] = {};
+    double m_wt_1d[max_n] = {};
+    double m_phi_1d[max_n][max_n] = {};
+    double m_dphi_1d[max_n][max_n] = {};
+    double m_phi_child_1d[ndirs][max_n][max_n] = {};
+    double m_phi_side_1d[ndirs][max_n] = {};
+    double m_mass[max_modes] = {};
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int pt_1d(int pt, int d) const {
+      int const n = m_p + 1;
+      if (d == 0) return pt % n;
+      if (d == 1) return (pt / n) % n;
+      return pt / (n * n);
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    static int tangent(int axis, int d) {
+      if (d == 0) return (axis == X) ? Y : X;
+      return (axis == Z) ? Y : Z;
+    }
+  public:
+    void init(int dim, int p, bool tensor);
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int dim() const { return m_dim; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int p() const { return m_p; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nmodes() const { return m_nmodes; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int tensor_mode(int t) const { return m_tensor_mode[t]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_1d(int pt, int deg) const { return m_phi_1d[pt][deg]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double dphi_1d(int pt, int deg) const { return m_dphi_1d[pt][deg]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_child_1d(int which_child, int pt, int deg) const {
+      return m_phi_child_1d[which_child][pt][deg];
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_side_1d(int dir, int deg) const { return m_phi_side_1d[dir][deg]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double mass(int m) const { return m_mass[m]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double wt_intr(int pt) const {
+      double wt = 1.;
+      for (int d = 0; d < m_dim; ++d) wt *= m_wt_1d[pt_1d(pt, d)];
+      return wt;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double wt_side(int pt) const {
+      double wt = 1.;
+      for (int d = 0; d < m_dim-1; ++d) wt *= m_wt_1d[pt_1d(pt, d)];
+      return wt;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_intr(int pt, int m) const {
+      double phi = 1.;
+      for (int d = 0; d < m_dim; ++d) {
+        phi *= m_phi_1d[pt_1d(pt, d)][m_mode_deg[m][d]];
+      }
+      return phi;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double dphi_intr(int axis, int pt, int m) const {
+      double dphi = 1.;
+      for (int d = 0; d < m_dim; ++d) {
+        int const q = pt_1d(pt, d);
+        int const deg = m_mode_deg[m][d];
+        dphi *= (d == axis) ? m_dphi_1d[q][deg] : m_phi_1d[q][deg];
+      }
+      return dphi;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_side(int axis, int dir, int pt, int m) const {
+      double phi = m_phi_side_1d[dir][m_mode_deg[m][axis]];
+      for (int d = 0; d < m_dim-1; ++d) {
+        int const t = tangent(axis, d);
+        phi *= m_phi_1d[pt_1d(pt, d)][m_mode_deg[m][t]];
+      }
+      return phi;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_child_intr(int which_child, int pt, int m) const {
+      double phi = 1.;
+      for (int d = 0; d < m_dim; ++d) {
+        int const local = (which_child >> d) & 1;
+        phi *= m_phi_child_1d[local][pt_1d(pt, d)][m_mode_deg[m][d]];
+      }
+      return phi;
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    double phi_child_side(int axis, int dir, int which_child, int pt, int m) const {
+      double phi = m_phi_side_1d[dir][m_mode_deg[m][axis]];
+      for (int d = 0; d < m_dim-1; ++d) {
+        int const t = tangent(axis, d);
+        int const local = (which_child >> d) & 1;
+        phi *= m_phi_child_1d[local][pt_1d(pt, d)][m_mode_deg[m][t]];
+      }
+      return phi;
+    }
+};
 
 struct Basis {
   int dim = -1;
@@ -46,6 +155,12 @@ struct Basis {
   View<double**>    phi_corner;       // (corner_pt, mode)
   View<double**>    phi_corner2;      // (corner_pt, mode)
   View<double*>     mass;             // (mode)
+  View<int*>        tensor_mode;      // (tensor_mode)
+  View<double**>    phi_1d;           // (pt_1d, deg)
+  View<double**>    dphi_1d;          // (pt_1d, deg)
+  View<double***>   phi_child_1d;     // (which_child_1d, pt_1d, deg)
+  View<double**>    phi_side_1d;      // (dir, deg)
+  BasisTable        table;
   void init(int dim, int p, bool tensor);
 };
 
@@ -84,6 +199,12 @@ struct HostBasis {
   HView<double**>    phi_corner;      // (corner_pt, mode)
   HView<double**>    phi_corner2;     // (corner_pt, mode)
   HView<double*>     mass;            // (mode)
+  HView<int*>        tensor_mode;     // (tensor_mode)
+  HView<double**>    phi_1d;          // (pt_1d, deg)
+  HView<double**>    dphi_1d;         // (pt_1d, deg)
+  HView<double***>   phi_child_1d;    // (which_child_1d, pt_1d, deg)
+  HView<double**>    phi_side_1d;     // (dir, deg)
+  BasisTable         table;
   void init(int dim, int p, bool tensor);
 };
 
@@ -276,6 +397,9 @@ p3a::vector3<double> get_side_pt(BasisT const& b, int axis, int dir, int pt) {
   return xi;
 }
 
+[[nodiscard]] Basis const& get_basis(int dim, int p, bool tensor);
+void clear_basis_cache();
+
 void print_modal_ordering(int dim, int p, bool tensor);
 
 }
@@ -1,17 +1,455 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include "caliper/cali.h"
+
 #include "dgt_file.hpp"
+#include "dgt_grid.hpp"
+#include "dgt_mesh.hpp"
 
 namespace dgt {
 
 namespace binary {
 
+using Buffer = std::vector<char>;
+
+struct Cursor {
+  Buffer const& data;
+  std::size_t pos;
+};
+
+struct IndexEntry {
+  Point pt;
+  std::int64_t offset;
+  std::int64_t length;
+};
+
+static constexpr char magic[4] = {'D', 'G', 'T', 'B'};
+static constexpr std::int32_t version = 3;
+static constexpr std::int64_t header_size = 32;
+static constexpr std::int64_t entry_size = 32;
+
+static void verify_extension(std::filesystem::path const& path) {
+  if (path.extension() != ".dgb") {
+    throw std::runtime_error("binary::read_mesh - extension != .dgb");
+  }
+}
+
+static void verify_endian() {
+  std::uint32_t const one = 1;
+  unsigned char byte;
+  std::memcpy(&byte, &one, 1);
+  if (byte != 1) {
+    throw std::runtime_error("binary - big endian hosts are not supported");
+  }
+}
+
+static void verify_mpi(int err, std::filesystem::path const& path) {
+  if (err != MPI_SUCCESS) {
+    throw std::runtime_error("binary - MPI-IO failure: " + path.string());
+  }
+}
+
+static void verify_read(Cursor const& c, std::size_t size) {
+  if (c.pos + size > c.data.size()) {
+    throw std::runtime_error("binary - truncated file");
+  }
+}
+
+template <class T>
+static void write_value(Buffer& buf, T const& value) {
+  char const* bytes = reinterpret_cast<char const*>(&value);
+  buf.insert(buf.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T>
+static T read_value(Cursor& c) {
+  T value;
+  verify_read(c, sizeof(T));
+  std::memcpy(&value, c.data.data() + c.pos, sizeof(T));
+  c.pos += sizeof(T);
+  return value;
+}
+
+static void write_bytes(Buffer& buf, void const* data, std::size_t size) {
+  char const* bytes = static_cast<char const*>(data);
+  buf.insert(buf.end(), bytes, bytes + size);
+}
+
+static void read_bytes(Cursor& c, void* data, std::size_t size) {
+  verify_read(c, size);
+  std::memcpy(data, c.data.data() + c.pos, size);
+  c.pos += size;
+}
+
+template <class T>
+static void write_vec3(Buffer& buf, p3a::vector3<T> const& v) {
+  write_value(buf, v.x());
+  write_value(buf, v.y());
+  write_value(buf, v.z());
+}
+
+template <class T>
+static p3a::vector3<T> read_vec3(Cursor& c) {
+  p3a::vector3<T> v;
+  v.x() = read_value<T>(c);
+  v.y() = read_value<T>(c);
+  v.z() = read_value<T>(c);
+  return v;
+}
+
+static void write_point(Buffer& buf, Point const& pt) {
+  write_value(buf, std::int32_t(pt.depth));
+  write_vec3(buf, pt.ijk);
+}
+
+static Point read_point(Cursor& c) {
+  Point pt;
+  pt.depth = read_value<std::int32_t>(c);
+  pt.ijk = read_vec3<int>(c);
+  return pt;
+}
+
+static void write_string(Buffer& buf, std::string const& s) {
+  write_value(buf, std::int32_t(s.size()));
+  write_bytes(buf, s.data(), s.size());
+}
+
+static std::string read_string(Cursor& c) {
+  std::int32_t const size = read_value<std::int32_t>(c);
+  std::string s(size, '\0');
+  read_bytes(c, s.data(), size);
+  return s;
+}
+
+static void write_header(
+    Buffer& buf,
+    std::int64_t meta_size,
+    std::int64_t index_offset,
+    std::int64_t nblocks) {
+  write_bytes(buf, magic, sizeof(magic));
+  write_value(buf, version);
+  write_value(buf, meta_size);
+  write_value(buf, index_offset);
+  write_value(buf, nblocks);
+}
+
+static void read_header(
+    Cursor& c,
+    std::filesystem::path const& path,
+    std::int64_t& meta_size,
+    std::int64_t& index_offset,
+    std::int64_t& nblocks) {
+  char file_magic[4];
+  read_bytes(c, file_magic, sizeof(file_magic));
+  std::int32_t const file_version = read_value<std::int32_t>(c);
+  if (std::memcmp(file_magic, magic, sizeof(magic))) {
+    throw std::runtime_error("binary - invalid header: " + path.string());
+  }
+  if (file_version != version) {
+    throw std::runtime_error("binary - unsupported version: " + path.string());
+  }
+  meta_size = read_value<std::int64_t>(c);
+  index_offset = read_value<std::int64_t>(c);
+  nblocks = read_value<std::int64_t>(c);
+}
+
+static void write_meta(Buffer& buf, Mesh const& mesh) {
+  CALI_CXX_MARK_FUNCTION;
+  write_value(buf, std::int32_t(mesh.dim()));
+  write_value(buf, std::int32_t(mesh.basis().p));
+  write_value(buf, std::int32_t(mesh.basis().tensor));
+  write_value(buf, std::int32_t(mesh.nsoln()));
+  write_value(buf, std::int32_t(mesh.nmodal_eq()));
+  write_value(buf, std::int32_t(mesh.nflux_eq()));
+  write_vec3(buf, mesh.domain().lower());
+  write_vec3(buf, mesh.domain().upper());
+  write_vec3(buf, p3a::vector3<std::int32_t>(
+        mesh.periodic().x(), mesh.periodic().y(), mesh.periodic().z()));
+  write_vec3(buf, mesh.cell_grid().extents());
+  write_point(buf, mesh.tree().base());
+  std::vector<std::uint8_t> const bits = encode_tree(mesh.tree());
+  write_value(buf, std::int32_t(bits.size()));
+  write_bytes(buf, bits.data(), bits.size());
+  write_value(buf, std::int32_t(mesh.fields().size()));
+  for (FieldInfo const& field : mesh.fields()) {
+    write_string(buf, field.name);
+    write_value(buf, std::int32_t(field.ent_dim));
+    write_value(buf, std::int32_t(field.ncomps));
+  }
+}
+
+static void read_meta(Cursor& c, std::filesystem::path const& path, Mesh& mesh) {
+  CALI_CXX_MARK_FUNCTION;
+  int const dim = read_value<std::int32_t>(c);
+  int const p = read_value<std::int32_t>(c);
+  bool const tensor = read_value<std::int32_t>(c);
+  int const nsoln = read_value<std::int32_t>(c);
+  int const nmodal_eq = read_value<std::int32_t>(c);
+  int const nflux_eq = read_value<std::int32_t>(c);
+  p3a::vector3<double> const xmin = read_vec3<double>(c);
+  p3a::vector3<double> const xmax = read_vec3<double>(c);
+  p3a::vector3<std::int32_t> const periodic = read_vec3<std::int32_t>(c);
+  p3a::vector3<int> const cells = read_vec3<int>(c);
+  Point const base = read_point(c);
+  std::vector<std::uint8_t> bits(read_value<std::int32_t>(c));
+  read_bytes(c, bits.data(), bits.size());
+  std::vector<FieldInfo> fields(read_value<std::int32_t>(c));
+  for (FieldInfo& field : fields) {
+    field.name = read_string(c);
+    field.ent_dim = read_value<std::int32_t>(c);
+    field.ncomps = read_value<std::int32_t>(c);
+  }
+  if (dim != get_dim(cells)) {
+    throw std::runtime_error("binary - inconsistent dim: " + path.string());
+  }
+  mesh.set_domain({xmin, xmax});
+  mesh.set_periodic({bool(periodic.x()), bool(periodic.y()), bool(periodic.z())});
+  mesh.set_cell_grid(cells);
+  mesh.set_nsoln(nsoln);
+  mesh.set_nmodal_eq(nmodal_eq);
+  mesh.set_nflux_eq(nflux_eq);
+  mesh.init(p3a::grid3(base.ijk), p, tensor);
+  decode_tree(mesh.tree(), bits);
+  for (FieldInfo const& field : fields) {
+    mesh.add_field(field.name, field.ent_dim, field.ncomps);
+  }
+  mesh.rebuild();
+  mesh.allocate();
+}
+
+static void write_block(Buffer& buf, Block const& block) {
+  CALI_CXX_MARK_FUNCTION;
+  View<double***> U = block.soln(0);
+  auto U_host = Kokkos::create_mirror_view(U);
+  Kokkos::deep_copy(U_host, U);
+  write_point(buf, block.node()->pt());
+  for (int i = 0; i < 3; ++i) {
+    write_value(buf, std::int32_t(U.extent(i)));
+  }
+  write_bytes(buf, U_host.data(), U_host.span() * sizeof(double));
+}
+
+static void read_block(
+    Cursor& c,
+    std::filesystem::path const& path,
+    Block& block) {
+  CALI_CXX_MARK_FUNCTION;
+  View<double***> U = block.soln(0);
+  auto U_host = Kokkos::create_mirror_view(U);
+  Point const pt = read_point(c);
+  bool valid = (pt == block.node()->pt());
+  for (int i = 0; i < 3; ++i) {
+    if (read_value<std::int32_t>(c) != std::int32_t(U.extent(i))) valid = false;
+  }
+  if (!valid) {
+    throw std::runtime_error("binary - mismatched block: " + path.string());
+  }
+  read_bytes(c, U_host.data(), U_host.span() * sizeof(double));
+  Kokkos::deep_copy(U, U_host);
+}
+
+static void write_entry(Buffer& buf, IndexEntry const& entry) {
+  write_point(buf, entry.pt);
+  write_value(buf, entry.offset);
+  write_value(buf, entry.length);
+}
+
+static IndexEntry read_entry(Cursor& c) {
+  IndexEntry entry;
+  entry.pt = read_point(c);
+  entry.offset = read_value<std::int64_t>(c);
+  entry.length = read_value<std::int64_t>(c);
+  return entry;
+}
+
+static std::int64_t exscan(MPI_Comm comm, std::int64_t value) {
+  std::int64_t result = 0;
+  int rank;
+  MPI_Exscan(&value, &result, 1, MPI_INT64_T, MPI_SUM, comm);
+  MPI_Comm_rank(comm, &rank);
+  return (rank == 0) ? 0 : result;
+}
+
+static std::int64_t sum(MPI_Comm comm, std::int64_t value) {
+  std::int64_t result = 0;
+  MPI_Allreduce(&value, &result, 1, MPI_INT64_T, MPI_SUM, comm);
+  return result;
+}
+
+static bool any(MPI_Comm comm, bool value) {
+  int local = value ? 1 : 0;
+  int result = 0;
+  MPI_Allreduce(&local, &result, 1, MPI_INT, MPI_MAX, comm);
+  return result != 0;
+}
+
+class File {
+  private:
+    MPI_File m_file = MPI_FILE_NULL;
+  public:
+    File(MPI_Comm comm, std::filesystem::path const& path, int mode) {
+      int const err = MPI_File_open(comm, path.c_str(), mode, MPI_INFO_NULL, &m_file);
+      if (err != MPI_SUCCESS) {
+        throw std::runtime_error("binary - could not open: " + path.string());
+      }
+    }
+    File(File const&) = delete;
+    File& operator=(File const&) = delete;
+    ~File() { MPI_File_close(&m_file); }
+    [[nodiscard]] MPI_File get() const { return m_file; }
+};
+
+static constexpr std::int64_t max_chunk = std::numeric_limits<int>::max();
+
+static std::int64_t count_chunks(MPI_Comm comm, std::size_t size) {
+  std::int64_t const local = (std::int64_t(size) + max_chunk - 1) / max_chunk;
+  std::int64_t result = 0;
+  MPI_Allreduce(&local, &result, 1, MPI_INT64_T, MPI_MAX, comm);
+  return result;
+}
+
+static std::int64_t get_chunk_start(std::size_t size, std::int64_t chunk) {
+  return std::min(chunk * max_chunk, std::int64_t(size));
+}
+
+static int get_chunk_count(std::size_t size, std::int64_t start) {
+  return int(std::min(std::int64_t(size) - start, max_chunk));
+}
+
+static void write_at_all(
+    MPI_Comm comm,
+    MPI_File file,
+    std::filesystem::path const& path,
+    std::int64_t offset,
+    Buffer const& buf) {
+  std::int64_t const nchunks = count_chunks(comm, buf.size());
+  for (std::int64_t chunk = 0; chunk < nchunks; ++chunk) {
+    std::int64_t const start = get_chunk_start(buf.size(), chunk);
+    verify_mpi(MPI_File_write_at_all(
+          file, offset + start, buf.data() + start,
+          get_chunk_count(buf.size(), start),
+          MPI_BYTE, MPI_STATUS_IGNORE), path);
+  }
+}
+
+static void read_at(
+    MPI_File file,
+    std::filesystem::path const& path,
+    std::int64_t offset,
+    Buffer& buf) {
+  for (std::int64_t start = 0; start < std::int64_t(buf.size()); start += max_chunk) {
+    verify_mpi(MPI_File_read_at(
+          file, offset + start, buf.data() + start,
+          get_chunk_count(buf.size(), start),
+          MPI_BYTE, MPI_STATUS_IGNORE), path);
+  }
+}
+
+static void read_at_all(
+    MPI_Comm comm,
+    MPI_File file,
+    std::filesystem::path const& path,
+    std::int64_t offset,
+    Buffer& buf) {
+  std::int64_t const nchunks = count_chunks(comm, buf.size());
+  for (std::int64_t chunk = 0; chunk < nchunks; ++chunk) {
+    std::int64_t const start = get_chunk_start(buf.size(), chunk);
+    verify_mpi(MPI_File_read_at_all(
+          file, offset + start, buf.data() + start,
+          get_chunk_count(buf.size(), start),
+          MPI_BYTE, MPI_STATUS_IGNORE), path);
+  }
+}
+
 void write_mesh(std::filesystem::path const& path, Mesh const& mesh) {
-  (void)path;
-  (void)mesh;
+  CALI_CXX_MARK_FUNCTION;
+  verify_endian();
+  std::filesystem::path const file_path(path.string() + ".dgb");
+  MPI_Comm comm = mesh.comm()->get();
+  Buffer meta;
+  Buffer blocks;
+  Buffer index;
+  std::vector<IndexEntry> entries;
+  write_meta(meta, mesh);
+  for (Node* leaf : mesh.owned_leaves()) {
+    std::int64_t const offset = blocks.size();
+    write_block(blocks, leaf->block);
+    entries.push_back({leaf->pt(), offset, std::int64_t(blocks.size()) - offset});
+  }
+  std::int64_t const data_start = header_size + meta.size();
+  std::int64_t const data_offset = data_start + exscan(comm, blocks.size());
+  std::int64_t const index_start = data_start + sum(comm, blocks.size());
+  std::int64_t const index_offset = index_start + entry_size * exscan(comm, entries.size());
+  for (IndexEntry& entry : entries) {
+    entry.offset += data_offset;
+    write_entry(index, entry);
+  }
+  Buffer head;
+  if (mesh.comm()->rank() == 0) {
+    write_header(head, meta.size(), index_start, mesh.leaves().size());
+    head.insert(head.end(), meta.begin(), meta.end());
+  }
+  File const file(comm, file_path, MPI_MODE_CREATE | MPI_MODE_WRONLY);
+  verify_mpi(MPI_File_set_size(file.get(), 0), file_path);
+  write_at_all(comm, file.get(), file_path, 0, head);
+  write_at_all(comm, file.get(), file_path, data_offset, blocks);
+  write_at_all(comm, file.get(), file_path, index_offset, index);
 }
 
 void read_mesh(std::filesystem::path const& path, Mesh& mesh) {
-  (void)path;
-  (void)mesh;
+  CALI_CXX_MARK_FUNCTION;
+  verify_endian();
+  verify_extension(path);
+  std::int64_t meta_size = 0;
+  std::int64_t index_start = 0;
+  std::int64_t nblocks = 0;
+  MPI_Comm comm = mesh.comm()->get();
+  File const file(comm, path, MPI_MODE_RDONLY);
+  Buffer head(header_size);
+  read_at_all(comm, file.get(), path, 0, head);
+  Cursor head_cursor{head, 0};
+  read_header(head_cursor, path, meta_size, index_start, nblocks);
+  Buffer meta(meta_size);
+  read_at_all(comm, file.get(), path, header_size, meta);
+  Cursor meta_cursor{meta, 0};
+  read_meta(meta_cursor, path, mesh);
+  Buffer index(nblocks * entry_size);
+  read_at_all(comm, file.get(), path, index_start, index);
+  Cursor index_cursor{index, 0};
+  std::unordered_map<Node*, IndexEntry> entries;
+  for (std::int64_t i = 0; i < nblocks; ++i) {
+    IndexEntry const entry = read_entry(index_cursor);
+    entries[mesh.tree().find(entry.pt)] = entry;
+  }
+  bool missing = false;
+  for (Node* leaf : mesh.owned_leaves()) {
+    if (entries.find(leaf) == entries.end()) missing = true;
+  }
+  if (any(comm, missing)) {
+    throw std::runtime_error("binary - missing block: " + path.string());
+  }
+  std::string error;
+  try {
+    for (Node* leaf : mesh.owned_leaves()) {
+      IndexEntry const& entry = entries.at(leaf);
+      Buffer data(entry.length);
+      read_at(file.get(), path, entry.offset, data);
+      Cursor data_cursor{data, 0};
+      read_block(data_cursor, path, leaf->block);
+    }
+  } catch (std::exception const& e) {
+    error = e.what();
+  }
+  if (any(comm, !error.empty())) {
+    if (error.empty()) error = "binary - block read failed on another rank: " + path.string();
+    throw std::runtime_error(error);
+  }
 }
 
 }
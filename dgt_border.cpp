@@ -5,10 +5,12 @@
 #include "dgt_amr.hpp"
 #include "dgt_basis.hpp"
 #include "dgt_border.hpp"
+#include "dgt_dispatch.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_interp.hpp"
 #include "dgt_mesh.hpp"
 #include "dgt_spatial.hpp"
+#include "dgt_trace.hpp"
 
 namespace dgt {
 
@@ -228,6 +230,33 @@ View<double****> Border::amr_noncon_flux2() const {
   return m_amr_noncon_flux2;
 }
 
+static View<double***> merge_child_pts(View<double****> v) {
+  int const nsides = v.extent(0);
+  int const nchild_pts = v.extent(1) * v.extent(2);
+  int const neq = v.extent(3);
+  return View<double***>(v.data(), nsides, nchild_pts, neq);
+}
+
+p3a::static_array<p3a::simd_view<double***>, ndirs> Border::simd_soln() const {
+  p3a::static_array<View<double***>, ndirs> const U = soln();
+  p3a::static_array<p3a::simd_view<double***>, ndirs> r;
+  r[left]  = p3a::simd_view<double***>(U[left]);
+  r[right] = p3a::simd_view<double***>(U[right]);
+  return r;
+}
+
+p3a::static_array<p3a::simd_view<double***>, ndirs> Border::simd_amr_soln() const {
+  p3a::static_array<View<double****>, ndirs> const U = amr_soln();
+  p3a::static_array<p3a::simd_view<double***>, ndirs> r;
+  r[left]  = p3a::simd_view<double***>(merge_child_pts(U[left]));
+  r[right] = p3a::simd_view<double***>(merge_child_pts(U[right]));
+  return r;
+}
+
+p3a::simd_view<double***> Border::simd_amr_flux() const {
+  return p3a::simd_view<double***>(merge_child_pts(m_amr_flux));
+}
+
 void Border::set_axis(int axis) {
   m_axis = axis;
 }
@@ -414,10 +443,8 @@ static p3a::static_array<View<double***>, ndirs> get_amr_U_avg(Border& border) {
   return r;
 }
 
-static void fill_border(Border& border, int soln_idx) {
-  CALI_CXX_MARK_FUNCTION;
-  if (border.type() == COARSE_TO_FINE) return;
-  verify_border(border);
+template <class O>
+static void fill_border(Border& border, int soln_idx, bool use_traces) {
   Block const& block = border.node()->block;
   int const dim = block.dim();
   int const axis = border.axis();
@@ -425,9 +452,9 @@ static void fill_border(Border& border, int soln_idx) {
   int const idir = invert_dir(dir);
   int const p = block.basis().p;
   bool const tensor = block.basis().tensor;
-  int const npts = num_pts(dim-1, p);
+  int const npts = O::nside_pts;
   int const neq = block.soln(0).extent(1);
-  Basis const b = block.basis();
+  BasisTable const b = block.basis().table;
   p3a::grid3 const g = block.cell_grid();
   p3a::grid3 const cell_grid = generalize(g);
   p3a::subgrid3 const sides = generalize(get_adj_sides(g, axis, dir));
@@ -436,6 +463,8 @@ static void fill_border(Border& border, int soln_idx) {
   p3a::static_array<View<double***>, ndirs> U_border = get_U(border);
   p3a::static_array<View<double**>, ndirs> U_avg_border = get_U_avg(border);
   verify(dim, p, tensor, neq, cell_grid, border_side_grid, U, U_border, U_avg_border);
+  View<double**> T;
+  if (use_traces) T = block.field(trace_field).data();
 
   auto f = [=] P3A_DEVICE (p3a::vector3<int> const& side_ijk, int const& eq, int const& pt) {
     p3a::vector3<int> const border_side_ijk = get_border_ijk(side_ijk, axis);
@@ -447,17 +476,27 @@ static void fill_border(Border& border, int soln_idx) {
       for (int msg_dir = 0; msg_dir < ndirs; ++msg_dir)
         U_avg_border[msg_dir](border_side, eq) = avg;
     }
-    double const val = interp_scalar_side(U, b, cell, axis, dir, pt, eq);
+    double const val = use_traces ?
+      T(cell, get_trace_comp(axis, dir, pt, eq, npts, neq)) :
+      interp_scalar_side<O::nmodes>(U, b, cell, axis, dir, pt, eq);
     for (int msg_dir = 0; msg_dir < ndirs; ++msg_dir)
       U_border[msg_dir](border_side, pt, eq) = val;
   };
   p3a::for_each(p3a::execution::par, sides, neq, npts, f);
 }
 
-static void fill_amr_border(Border& border, int soln_idx) {
+static void fill_border(Border& border, int soln_idx, bool use_traces) {
   CALI_CXX_MARK_FUNCTION;
-  if (border.type() != COARSE_TO_FINE) return;
+  if (border.type() == COARSE_TO_FINE) return;
   verify_border(border);
+  auto f = [&] (auto order) {
+    fill_border<decltype(order)>(border, soln_idx, use_traces);
+  };
+  dispatch(border.node()->block.basis(), f);
+}
+
+template <class O>
+static void fill_amr_border(Border& border, int soln_idx) {
   Block const& block = border.node()->block;
   int const dim = block.dim();
   int const axis = border.axis();
@@ -465,10 +504,10 @@ static void fill_amr_border(Border& border, int soln_idx) {
   int const idir = invert_dir(dir);
   int const p = block.basis().p;
   bool const tensor = block.basis().tensor;
-  int const npts = num_pts(dim-1, p);
+  int const npts = O::nside_pts;
   int const neq = block.soln(0).extent(1);
-  int const nchild = num_child(dim-1);
-  Basis const b = block.basis();
+  int const nchild = O::nchild_sides;
+  BasisTable const b = block.basis().table;
   p3a::grid3 const g = block.cell_grid();
   p3a::grid3 const cell_grid = generalize(g);
   p3a::subgrid3 const sides = generalize(get_adj_sides(g, axis, dir));
@@ -489,7 +528,7 @@ static void fill_amr_border(Border& border, int soln_idx) {
         for (int msg_dir = 0; msg_dir < ndirs; ++msg_dir)
           U_avg_border[msg_dir](border_side, which_child, eq) = avg;
       }
-      double const val = interp_scalar_child_side(U, b, cell, axis, dir, which_child, pt, eq);
+      double const val = interp_scalar_child_side<O::nmodes>(U, b, cell, axis, dir, which_child, pt, eq);
       for (int msg_dir = 0; msg_dir < ndirs; ++msg_dir)
         U_border[msg_dir](border_side, which_child, pt, eq) = val;
     }
@@ -497,6 +536,16 @@ static void fill_amr_border(Border& border, int soln_idx) {
   p3a::for_each(p3a::execution::par, sides, neq, npts, f);
 }
 
+static void fill_amr_border(Border& border, int soln_idx) {
+  CALI_CXX_MARK_FUNCTION;
+  if (border.type() != COARSE_TO_FINE) return;
+  verify_border(border);
+  auto f = [&] (auto order) {
+    fill_amr_border<decltype(order)>(border, soln_idx);
+  };
+  dispatch(border.node()->block.basis(), f);
+}
+
 static void fill_amr_buffer_from_border(
     Border& border,
     int border_which_child) {
@@ -666,13 +715,13 @@ static void post_transfer(Border& border) {
   }
 }
 
-void begin_border_transfer(Mesh& mesh, int soln_idx) {
+void begin_border_transfer(Mesh& mesh, int soln_idx, bool use_traces) {
   CALI_CXX_MARK_FUNCTION;
   for (Node* leaf : mesh.owned_leaves()) {
     for (int axis = 0; axis < mesh.dim(); ++axis) {
       for (int dir = 0; dir < ndirs; ++dir) {
         Border& border = leaf->block.border(axis, dir);
-        fill_border(border, soln_idx);
+        fill_border(border, soln_idx, use_traces);
         fill_amr_border(border, soln_idx);
         fill_amr_buffers_from_border(border);
         p3a::execution::par.synchronize();
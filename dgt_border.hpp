@@ -2,6 +2,7 @@
 
 #include <vector>
 
+#include "p3a_simd_view.hpp"
 #include "p3a_static_array.hpp"
 
 #include "dgt_defines.hpp"
@@ -62,6 +63,9 @@ class Border {
     [[nodiscard]] View<double****> amr_noncon_avg2() const;
     [[nodiscard]] View<double****> amr_noncon_flux1() const;
     [[nodiscard]] View<double****> amr_noncon_flux2() const;
+    [[nodiscard]] p3a::static_array<p3a::simd_view<double***>, ndirs> simd_soln() const;
+    [[nodiscard]] p3a::static_array<p3a::simd_view<double***>, ndirs> simd_amr_soln() const;
+    [[nodiscard]] p3a::simd_view<double***> simd_amr_flux() const;
     void set_axis(int axis);
     void set_dir(int dir);
     void set_type(int type);
@@ -72,7 +76,7 @@ class Border {
     void deallocate();
 };
 
-void begin_border_transfer(Mesh& m, int soln_idx);
+void begin_border_transfer(Mesh& m, int soln_idx, bool use_traces = false);
 void end_border_transfer(Mesh& m);
 
 }
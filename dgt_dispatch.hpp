@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdexcept>
+
+#include "dgt_basis.hpp"
+
+namespace dgt {
+
+template <int Dim, int P, bool Tensor>
+struct Order {
+  static constexpr int dim = Dim;
+  static constexpr int p = P;
+  static constexpr bool tensor = Tensor;
+  static constexpr int nmodes = num_modes(Dim, P, Tensor);
+  static constexpr int nintr_pts = num_pts(Dim, P);
+  static constexpr int nside_pts = num_pts(Dim-1, P);
+  static constexpr int nchild = num_child(Dim);
+  static constexpr int nchild_sides = num_child(Dim-1);
+};
+
+template <int Dim, int P, class Functor>
+void dispatch_tensor(bool tensor, Functor&& f) {
+  if (tensor) f(Order<Dim, P, true>());
+  else f(Order<Dim, P, false>());
+}
+
+template <int Dim, class Functor>
+void dispatch_p(int p, bool tensor, Functor&& f) {
+  switch (p) {
+    case 0: dispatch_tensor<Dim, 0>(tensor, f); break;
+    case 1: dispatch_tensor<Dim, 1>(tensor, f); break;
+    case 2: dispatch_tensor<Dim, 2>(tensor, f); break;
+    default: throw std::runtime_error("dispatch - unsupported p");
+  }
+}
+
+template <class Functor>
+void dispatch(int dim, int p, bool tensor, Functor&& f) {
+  switch (dim) {
+    case 1: dispatch_p<1>(p, tensor, f); break;
+    case 2: dispatch_p<2>(p, tensor, f); break;
+    case 3: dispatch_p<3>(p, tensor, f); break;
+    default: throw std::runtime_error("dispatch - unsupported dim");
+  }
+}
+
+template <class Functor>
+void dispatch(Basis const& b, Functor&& f) {
+  dispatch(b.dim, b.p, b.tensor, f);
+}
+
+}
@@ -0,0 +1,37 @@
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "dgt_error.hpp"
+
+namespace dgt {
+
+static void verify_init(View<int*> data) {
+  if (data.size() == 0) {
+    throw std::runtime_error("ErrorFlag - not initialized");
+  }
+}
+
+void ErrorFlag::init() {
+  m_data = View<int*>("dgt::ErrorFlag::m_data", NENTRIES);
+  reset();
+}
+
+void ErrorFlag::reset() {
+  verify_init(m_data);
+  Kokkos::deep_copy(m_data, 0);
+}
+
+ErrorRecord ErrorFlag::check() const {
+  CALI_CXX_MARK_FUNCTION;
+  verify_init(m_data);
+  auto h_data = Kokkos::create_mirror_view_and_copy(Kokkos::HostSpace(), m_data);
+  ErrorRecord record;
+  record.code = h_data(CODE);
+  record.kernel = h_data(KERNEL);
+  record.block = h_data(BLOCK);
+  record.cell = h_data(CELL);
+  return record;
+}
+
+}
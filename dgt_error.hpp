@@ -0,0 +1,56 @@
+#pragma once
+
+#include "p3a_simd_view.hpp"
+
+#include "dgt_views.hpp"
+
+namespace dgt {
+
+template <class T>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+int get_first_lane(p3a::device_simd_mask<T> const& mask) {
+  int constexpr width = p3a::device_simd<T>::size();
+  T lanes[width];
+  p3a::device_simd<T> const flags =
+    p3a::condition(mask, p3a::device_simd<T>(T(1)), p3a::device_simd<T>(T(0)));
+  flags.copy_to(lanes, p3a::element_aligned_tag());
+  for (int lane = 0; lane < width; ++lane) {
+    if (lanes[lane] != T(0)) return lane;
+  }
+  return 0;
+}
+
+struct ErrorRecord {
+  int code = 0;
+  int kernel = -1;
+  int block = -1;
+  int cell = -1;
+};
+
+class ErrorFlag {
+  private:
+    enum { CODE, KERNEL, BLOCK, CELL, NENTRIES };
+    View<int*> m_data;
+  public:
+    ErrorFlag() = default;
+    void init();
+    void reset();
+    [[nodiscard]] ErrorRecord check() const;
+    P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    void raise(int code, int kernel, int block, int cell) const {
+      if (Kokkos::atomic_compare_exchange(&m_data(CODE), 0, code) == 0) {
+        m_data(KERNEL) = kernel;
+        m_data(BLOCK) = block;
+        m_data(CELL) = cell;
+      }
+    }
+    template <class T>
+    P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    void raise(int code, int kernel, int block, int cell,
+        p3a::device_simd_mask<T> const& failed) const {
+      if (!any_of(failed)) return;
+      raise(code, kernel, block, cell + get_first_lane(failed));
+    }
+};
+
+}
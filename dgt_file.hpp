@@ -3,8 +3,11 @@
 #include <filesystem>
 #include <sstream>
 #include <string>
+#include <vector>
 #include <stdexcept>
 
+#include "mpicpp.hpp"
+
 #include "dgt_defines.hpp"
 #include "dgt_views.hpp"
 
@@ -12,6 +15,7 @@ namespace dgt {
 
 class Block;
 class Mesh;
+class OutputQueue;
 class Tree;
 
 template <class T>
@@ -46,6 +50,7 @@ void decode(std::string const& text, void* data, std::size_t size);
 
 namespace ascii {
 void write_mesh(std::filesystem::path const& path, Mesh const& mesh);
+void write_mesh(OutputQueue& queue, std::filesystem::path const& path, Mesh const& mesh);
 void read_mesh(std::filesystem::path const& path, Mesh& mesh);
 }
 
@@ -59,12 +64,78 @@ namespace vtk {
 template <class T>
 using VizView = Kokkos::DualView<T**, Kokkos::LayoutRight>;
 
+struct Compression {
+  bool enabled = true;
+  int level = 1;
+  std::uint64_t block_size = 1 << 16;
+  int nthreads = 1;
+};
+
+struct AppendedData {
+  Compression compression;
+  std::uint64_t nbytes = 0;
+  std::vector<std::string> arrays;
+};
+
 void write_vtr_start(
     std::stringstream& stream, Block const& block, double time, int step);
+void write_vtr_start(
+    std::stringstream& stream, Block const& block, double time, int step,
+    AppendedData& appended);
 template <class T>
 void write_field(std::stringstream& stream, std::string const& name, VizView<T> f);
+template <class T>
+void write_field(std::stringstream& stream, std::string const& name, VizView<T> f,
+    AppendedData& appended);
 void write_vtr_end(std::stringstream& stream);
-void write_vtm(std::stringstream& stream, std::string const& prefix, int nblocks);
+void write_vtr_end(
+    std::filesystem::path const& path,
+    std::stringstream& stream,
+    AppendedData const& appended);
+void write_vtm(
+    std::stringstream& stream,
+    std::string const& prefix,
+    int nblocks,
+    std::string const& extension = ".vtr");
+
+struct VtuArray {
+  std::string section;
+  std::string type;
+  std::string name;
+  int ncomps;
+  std::uint64_t offset;
+};
+
+struct VtuPiece {
+  int npoints = 0;
+  int ncells = 0;
+  std::vector<VtuArray> arrays;
+  AppendedData data;
+};
+
+struct VtuFile {
+  bool writer = false;
+  int group = -1;
+  int ngroups = 0;
+  Compression compression;
+  std::string pieces;
+  std::string data;
+};
+
+void add_vtu_blocks(
+    VtuPiece& piece,
+    int dim,
+    std::vector<Block const*> const& blocks,
+    bool averages = false);
+template <class T>
+void add_vtu_field(VtuPiece& piece, std::string const& name, std::vector<VizView<T>> const& fields);
+[[nodiscard]] int get_vtu_group(int rank, int nranks, int nwriters);
+void gather_vtu(mpicpp::comm* comm, int nwriters, VtuPiece const& piece, VtuFile& file);
+void write_vtu(
+    std::filesystem::path const& prefix,
+    VtuFile const& file,
+    double time,
+    int step);
 
 void write_tree(
     std::filesystem::path const& path,
@@ -314,6 +314,78 @@ p3a::static_vector<double, neq> interp_vec_eval(
   return val;
 }
 
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double interp_scalar_intr(
+    View<double***> U, BasisT const& b,
+    int cell, int pt, int eq) {
+  double val = U(cell, eq, 0) * b.phi_intr(pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U(cell, eq, m) * b.phi_intr(pt, m);
+  }
+  return val;
+}
+
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double interp_scalar_side(
+    View<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int pt, int eq) {
+  double val = U(cell, eq, 0) * b.phi_side(axis, dir, pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U(cell, eq, m) * b.phi_side(axis, dir, pt, m);
+  }
+  return val;
+}
+
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double interp_scalar_child_intr(
+    View<double***> U, BasisT const& b,
+    int cell, int which_child, int pt, int eq) {
+  double val = U(cell, eq, 0) * b.phi_child_intr(which_child, pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U(cell, eq, m) * b.phi_child_intr(which_child, pt, m);
+  }
+  return val;
+}
+
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double interp_scalar_child_side(
+    View<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int which_child, int pt, int eq) {
+  double val = U(cell, eq, 0) * b.phi_child_side(axis, dir, which_child, pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U(cell, eq, m) * b.phi_child_side(axis, dir, which_child, pt, m);
+  }
+  return val;
+}
+
+template <int neq, int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<double, neq> interp_vec_intr(
+    View<double***> U, BasisT const& b,
+    int cell, int pt) {
+  p3a::static_vector<double, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = interp_scalar_intr<nmodes>(U, b, cell, pt, eq);
+  }
+  return val;
+}
+
+template <int neq, int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<double, neq> interp_vec_side(
+    View<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int pt) {
+  p3a::static_vector<double, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = interp_scalar_side<nmodes>(U, b, cell, axis, dir, pt, eq);
+  }
+  return val;
+}
+
 template <int neq>
 [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
 p3a::static_vector<double, neq> gather_avg(View<double***> U, int cell) {
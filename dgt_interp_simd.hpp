@@ -311,6 +311,69 @@ p3a::static_vector<p3a::device_simd<double>, neq> gather_avg(
   return val;
 }
 
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::device_simd<double> interp_scalar_intr(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int pt, int eq,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::device_simd<double> val = U.load(cell, eq, 0, mask) * b.phi_intr(pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U.load(cell, eq, m, mask) * b.phi_intr(pt, m);
+  }
+  return val;
+}
+
+template <int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::device_simd<double> interp_scalar_side(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int pt, int eq,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::device_simd<double> val = U.load(cell, eq, 0, mask) * b.phi_side(axis, dir, pt, 0);
+  for (int m = 1; m < nmodes; ++m) {
+    val += U.load(cell, eq, m, mask) * b.phi_side(axis, dir, pt, m);
+  }
+  return val;
+}
+
+template <int neq, int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<p3a::device_simd<double>, neq> interp_vec_intr(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int pt,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::static_vector<p3a::device_simd<double>, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = interp_scalar_intr<nmodes>(U, b, cell, pt, eq, mask);
+  }
+  return val;
+}
+
+template <int neq, int nmodes, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<p3a::device_simd<double>, neq> interp_vec_side(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int pt,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::static_vector<p3a::device_simd<double>, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = interp_scalar_side<nmodes>(U, b, cell, axis, dir, pt, eq, mask);
+  }
+  return val;
+}
+
+template <int neq>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<p3a::device_simd<double>, neq> gather_pt(
+    p3a::simd_view<double***> U, int side, int pt, p3a::device_simd_mask<double> const& mask) {
+  p3a::static_vector<p3a::device_simd<double>, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = U.load(side, pt, eq, mask);
+  }
+  return val;
+}
+
 }
 
 #ifdef __GNUC__
@@ -6,7 +6,9 @@
 
 #include "caliper/cali-manager.h"
 
+#include "dgt_basis.hpp"
 #include "dgt_library.hpp"
+#include "dgt_reduce.hpp"
 
 namespace dgt {
 
@@ -33,6 +35,8 @@ class Library::impl {
       m_caliper.start();
     }
     ~impl() {
+      clear_basis_cache();
+      free_reduce_types();
       m_caliper.flush();
     }
 };
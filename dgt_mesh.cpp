@@ -165,6 +165,10 @@ std::vector<FieldInfo> const& Mesh::fields() const {
   return m_fields;
 }
 
+BlockPack const& Mesh::pack() const {
+  return m_pack;
+}
+
 void Mesh::set_comm(mpicpp::comm* comm) {
   m_comm = comm;
 }
@@ -211,7 +215,7 @@ void Mesh::init(p3a::grid3 const& block_grid, int p, bool tensor) {
   verify_initial_tree(tree());
   verify_dims(m_cell_grid, block_grid);
   m_tree.init(block_grid);
-  m_basis.init(dim(), p, tensor);
+  m_basis = get_basis(dim(), p, tensor);
 }
 
 static Point get_adj_pt(Point const& pt, int axis, int dir) {
@@ -335,6 +339,12 @@ void Mesh::allocate() {
   for (Node* leaf : m_owned_leaves) {
     leaf->block.allocate(m_nsoln, m_nmodal_eq, m_nflux_eq);
   }
+  repack();
+}
+
+void Mesh::repack() {
+  CALI_CXX_MARK_FUNCTION;
+  m_pack.build(*this);
 }
 
 static void free_branch_node(int dim, Node* node) {
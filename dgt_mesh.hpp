@@ -8,6 +8,7 @@
 
 #include "dgt_basis.hpp"
 #include "dgt_field.hpp"
+#include "dgt_pack.hpp"
 #include "dgt_tree.hpp"
 
 namespace dgt {
@@ -26,6 +27,7 @@ class Mesh {
     std::vector<Node*> m_owned_leaves;
     std::vector<FieldInfo> m_fields;
     Tree m_tree;
+    BlockPack m_pack;
   public:
     Mesh() = default;
     [[nodiscard]] mpicpp::comm* comm() const;
@@ -43,6 +45,7 @@ class Mesh {
     [[nodiscard]] std::vector<Node*> const& leaves() const;
     [[nodiscard]] std::vector<Node*> const& owned_leaves() const;
     [[nodiscard]] std::vector<FieldInfo> const& fields() const;
+    [[nodiscard]] BlockPack const& pack() const;
     void set_comm(mpicpp::comm* comm);
     void set_domain(p3a::box3<double> const& domain);
     void set_periodic(p3a::vector3<bool> const& periodic);
@@ -57,6 +60,7 @@ class Mesh {
     void rebuild();
     void verify();
     void allocate();
+    void repack();
     void clean();
 };
 
@@ -0,0 +1,91 @@
+#include <iostream>
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "dgt_output.hpp"
+
+namespace dgt {
+
+static void verify_capacity(std::size_t capacity) {
+  if (capacity < 1) {
+    throw std::runtime_error("OutputQueue - invalid capacity");
+  }
+}
+
+OutputQueue::OutputQueue(std::size_t capacity) :
+  m_capacity(capacity) {
+  verify_capacity(capacity);
+  m_thread = std::thread([this] () { run(); });
+}
+
+OutputQueue::~OutputQueue() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_cv.notify_all();
+  m_thread.join();
+  if (!m_error) return;
+  try {
+    std::rethrow_exception(m_error);
+  } catch (std::exception const& e) {
+    std::cerr << "OutputQueue - unreported job error: " << e.what() << "\n";
+  } catch (...) {
+    std::cerr << "OutputQueue - unreported job error\n";
+  }
+}
+
+std::size_t OutputQueue::capacity() const {
+  return m_capacity;
+}
+
+void OutputQueue::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_cv.wait(lock, [this] () { return m_stop || !m_jobs.empty(); });
+    if (m_jobs.empty()) return;
+    std::function<void()> job = std::move(m_jobs.front());
+    m_jobs.pop_front();
+    m_busy = true;
+    lock.unlock();
+    try {
+      job();
+    } catch (...) {
+      lock.lock();
+      if (!m_error) m_error = std::current_exception();
+      lock.unlock();
+    }
+    lock.lock();
+    m_busy = false;
+    m_cv.notify_all();
+  }
+}
+
+void OutputQueue::rethrow() {
+  if (!m_error) return;
+  std::exception_ptr error = m_error;
+  m_error = nullptr;
+  std::rethrow_exception(error);
+}
+
+void OutputQueue::push(std::function<void()> job) {
+  CALI_CXX_MARK_FUNCTION;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto has_room = [this] () {
+    return m_jobs.size() + (m_busy ? 1 : 0) < m_capacity;
+  };
+  m_cv.wait(lock, has_room);
+  rethrow();
+  m_jobs.push_back(std::move(job));
+  m_cv.notify_all();
+}
+
+void OutputQueue::flush() {
+  CALI_CXX_MARK_FUNCTION;
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cv.wait(lock, [this] () { return m_jobs.empty() && !m_busy; });
+  rethrow();
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace dgt {
+
+// Jobs run in order on one worker thread. At most capacity jobs, counting
+// the one running, are held at once; push() blocks until one finishes.
+// An exception thrown by a job is rethrown by the next push() or flush(),
+// so call flush() to observe errors from the last jobs; the destructor
+// only reports them to stderr.
+class OutputQueue {
+  private:
+    std::size_t m_capacity = 2;
+    bool m_busy = false;
+    bool m_stop = false;
+    std::deque<std::function<void()>> m_jobs;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::thread m_thread;
+    void run();
+    void rethrow();
+  public:
+    OutputQueue(std::size_t capacity = 2);
+    OutputQueue(OutputQueue&&) = delete;
+    OutputQueue& operator=(OutputQueue&&) = delete;
+    OutputQueue(OutputQueue const&) = delete;
+    OutputQueue& operator=(OutputQueue const&) = delete;
+    ~OutputQueue();
+    [[nodiscard]] std::size_t capacity() const;
+    void push(std::function<void()> job);
+    void flush();
+};
+
+}
@@ -0,0 +1,75 @@
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "dgt_basis.hpp"
+#include "dgt_grid.hpp"
+#include "dgt_mesh.hpp"
+#include "dgt_pack.hpp"
+#include "dgt_trace.hpp"
+
+namespace dgt {
+
+static void verify_nsoln(int nsoln) {
+  if ((nsoln < 1) || (nsoln > max_nsoln)) {
+    throw std::runtime_error("BlockPack - invalid nsoln");
+  }
+}
+
+static void verify_block(Block const& block, int nsoln) {
+  if (block.nsoln() != nsoln) {
+    throw std::runtime_error("BlockPack - unallocated block");
+  }
+}
+
+void BlockPack::build(Mesh const& mesh) {
+  CALI_CXX_MARK_FUNCTION;
+  std::vector<Node*> const& leaves = mesh.owned_leaves();
+  Basis const& b = mesh.basis();
+  verify_nsoln(mesh.nsoln());
+  m_dim = mesh.dim();
+  m_nblocks = leaves.size();
+  m_nsoln = mesh.nsoln();
+  m_nmodal_eq = mesh.nmodal_eq();
+  m_nflux_eq = mesh.nflux_eq();
+  m_nmodes = b.nmodes;
+  m_nside_pts = num_pts(m_dim-1, b.p);
+  m_ntrace_comps = 0;
+  m_cell_grid = generalize(mesh.cell_grid());
+  for (int axis = 0; axis < DIMS; ++axis) {
+    m_side_grid[axis] = get_side_grid(m_cell_grid, axis);
+  }
+  HView<PackedBlock*> blocks("dgt::BlockPack::m_blocks", m_nblocks);
+  for (int i = 0; i < m_nblocks; ++i) {
+    Block const& block = leaves[i]->block;
+    verify_block(block, m_nsoln);
+    PackedBlock& pb = blocks(i);
+    pb.id = block.id();
+    pb.origin = block.domain().lower();
+    pb.dx = block.dx();
+    pb.cell_detJ = block.cell_detJ();
+    for (int axis = 0; axis < DIMS; ++axis) {
+      pb.side_detJ[axis] = 0.;
+      pb.amr_side_detJ[axis] = 0.;
+      pb.flux[axis] = nullptr;
+    }
+    for (int axis = 0; axis < m_dim; ++axis) {
+      pb.side_detJ[axis] = block.side_detJ(axis);
+      pb.amr_side_detJ[axis] = block.amr_side_detJ(axis);
+      pb.flux[axis] = block.flux(axis).data();
+    }
+    for (int idx = 0; idx < max_nsoln; ++idx) {
+      pb.soln[idx] = (idx < m_nsoln) ? block.soln(idx).data() : nullptr;
+    }
+    pb.resid = block.resid().data();
+    pb.trace = nullptr;
+    if (has_traces(block)) {
+      Field const& trace = block.field(trace_field);
+      pb.trace = trace.data().data();
+      m_ntrace_comps = trace.ncomps();
+    }
+  }
+  copy(blocks, m_blocks);
+}
+
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "p3a_for_each.hpp"
+#include "p3a_grid3.hpp"
+#include "p3a_simd_view.hpp"
+
+#include "dgt_defines.hpp"
+#include "dgt_views.hpp"
+
+namespace dgt {
+
+class Mesh;
+
+static constexpr int max_nsoln = 4;
+
+template <class T>
+using UnmanagedView = typename Kokkos::View<T, Kokkos::LayoutLeft, Kokkos::MemoryUnmanaged>;
+
+struct PackedBlock {
+  int id;
+  p3a::vector3<double> origin;
+  p3a::vector3<double> dx;
+  double cell_detJ;
+  double side_detJ[DIMS];
+  double amr_side_detJ[DIMS];
+  double* soln[max_nsoln];
+  double* flux[DIMS];
+  double* resid;
+  double* trace;
+};
+
+class BlockPack {
+  private:
+    int m_dim = -1;
+    int m_nblocks = 0;
+    int m_nsoln = 0;
+    int m_nmodal_eq = 0;
+    int m_nflux_eq = 0;
+    int m_nmodes = 0;
+    int m_nside_pts = 0;
+    int m_ntrace_comps = 0;
+    p3a::grid3 m_cell_grid = {0,0,0};
+    p3a::grid3 m_side_grid[DIMS] = {{0,0,0}, {0,0,0}, {0,0,0}};
+    View<PackedBlock*> m_blocks;
+  public:
+    BlockPack() = default;
+    void build(Mesh const& mesh);
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int dim() const { return m_dim; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nblocks() const { return m_nblocks; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nsoln() const { return m_nsoln; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nmodal_eq() const { return m_nmodal_eq; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nflux_eq() const { return m_nflux_eq; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nmodes() const { return m_nmodes; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    int nside_pts() const { return m_nside_pts; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::grid3 cell_grid() const { return m_cell_grid; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::grid3 side_grid(int axis) const { return m_side_grid[axis]; }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    PackedBlock const& block(int b) const { return m_blocks(b); }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    UnmanagedView<double***> soln(int b, int idx) const {
+      return UnmanagedView<double***>(m_blocks(b).soln[idx],
+          m_cell_grid.size(), m_nmodal_eq, m_nmodes);
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    UnmanagedView<double***> resid(int b) const {
+      return UnmanagedView<double***>(m_blocks(b).resid,
+          m_cell_grid.size(), m_nmodal_eq, m_nmodes);
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    UnmanagedView<double***> flux(int b, int axis) const {
+      return UnmanagedView<double***>(m_blocks(b).flux[axis],
+          m_side_grid[axis].size(), m_nside_pts, m_nflux_eq);
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    UnmanagedView<double**> trace(int b) const {
+      return UnmanagedView<double**>(m_blocks(b).trace,
+          m_cell_grid.size(), m_ntrace_comps);
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::simd_view<double***> simd_soln(int b, int idx) const {
+      return p3a::simd_view<double***>(View<double***>(soln(b, idx)));
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::simd_view<double***> simd_resid(int b) const {
+      return p3a::simd_view<double***>(View<double***>(resid(b)));
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::simd_view<double***> simd_flux(int b, int axis) const {
+      return p3a::simd_view<double***>(View<double***>(flux(b, axis)));
+    }
+    [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+    p3a::simd_view<double***> simd_trace(int b) const {
+      return p3a::simd_view<double***>(View<double***>(m_blocks(b).trace,
+          m_cell_grid.size(), m_ntrace_comps, 1));
+    }
+};
+
+template <class ExecutionPolicy, class Functor>
+void for_each_block_subgrid(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    p3a::subgrid3 const& s,
+    Functor const& f) {
+  if ((pack.nblocks() == 0) || (s.size() == 0)) return;
+  p3a::vector3<int> const lower = s.lower();
+  p3a::vector3<int> const n = s.extents();
+  p3a::grid3 const pack_grid(n.x(), n.y(), n.z() * pack.nblocks());
+  auto functor = [=] P3A_DEVICE (p3a::vector3<int> const& ijk) {
+    int const block = ijk.z() / n.z();
+    p3a::vector3<int> const local(ijk.x(), ijk.y(), ijk.z() - block * n.z());
+    f(block, lower + local);
+  };
+  p3a::for_each(policy, pack_grid, functor);
+}
+
+template <class T, class ExecutionPolicy, class Functor>
+void simd_for_each_block_subgrid(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    p3a::subgrid3 const& s,
+    Functor const& f) {
+  if ((pack.nblocks() == 0) || (s.size() == 0)) return;
+  p3a::vector3<int> const lower = s.lower();
+  p3a::vector3<int> const n = s.extents();
+  p3a::subgrid3 const pack_subgrid(
+      p3a::vector3<int>(lower.x(), 0, 0),
+      p3a::vector3<int>(lower.x() + n.x(), n.y(), n.z() * pack.nblocks()));
+  auto functor = [=] P3A_DEVICE (
+      p3a::vector3<int> const& ijk,
+      p3a::device_simd_mask<T> const& mask) {
+    int const block = ijk.z() / n.z();
+    p3a::vector3<int> const local(0, ijk.y(), ijk.z() - block * n.z());
+    p3a::vector3<int> const offset(ijk.x(), lower.y(), lower.z());
+    f(block, local + offset, mask);
+  };
+  p3a::simd_for_each<T>(policy, pack_subgrid, functor);
+}
+
+template <class ExecutionPolicy, class Functor>
+void for_each_block_cell(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    Functor const& f) {
+  p3a::subgrid3 const cells(pack.cell_grid());
+  for_each_block_subgrid(policy, pack, cells, f);
+}
+
+template <class T, class ExecutionPolicy, class Functor>
+void simd_for_each_block_cell(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    Functor const& f) {
+  p3a::subgrid3 const cells(pack.cell_grid());
+  simd_for_each_block_subgrid<T>(policy, pack, cells, f);
+}
+
+template <class ExecutionPolicy, class Functor>
+void for_each_block_entry(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    int nentries,
+    Functor const& f) {
+  if ((pack.nblocks() == 0) || (nentries == 0)) return;
+  int const n = pack.nblocks() * nentries;
+  auto functor = [=] P3A_DEVICE (int const i) {
+    int const block = i / nentries;
+    f(block, i - block * nentries);
+  };
+  p3a::for_each(
+      policy,
+      p3a::counting_iterator(0),
+      p3a::counting_iterator(n),
+      functor);
+}
+
+}
@@ -0,0 +1,93 @@
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "dgt_reduce.hpp"
+
+namespace dgt {
+
+static void verify_sizes(int nmin, int nsum) {
+  if ((nmin < 0) || (nsum < 0) || (nmin + nsum > max_reduce)) {
+    throw std::runtime_error("GlobalReduce - invalid sizes");
+  }
+}
+
+static void verify_not_pending(MPI_Request request) {
+  if (request != MPI_REQUEST_NULL) {
+    throw std::runtime_error("GlobalReduce - reduction already pending");
+  }
+}
+
+ReduceValues make_reduce_values(int nmin, int nsum) {
+  verify_sizes(nmin, nsum);
+  ReduceValues r;
+  r.nmin = nmin;
+  r.nsum = nsum;
+  for (int i = 0; i < nmin; ++i) {
+    r.vals[i] = p3a::maximum_value<double>();
+  }
+  for (int i = nmin; i < nmin + nsum; ++i) {
+    r.vals[i] = 0.;
+  }
+  return r;
+}
+
+static void join_values(void* in, void* inout, int* len, MPI_Datatype*) {
+  ReduceValues const* a = static_cast<ReduceValues const*>(in);
+  ReduceValues* b = static_cast<ReduceValues*>(inout);
+  for (int i = 0; i < *len; ++i) {
+    b[i] = ReduceJoin()(a[i], b[i]);
+  }
+}
+
+static MPI_Datatype reduce_type = MPI_DATATYPE_NULL;
+static MPI_Op reduce_op = MPI_OP_NULL;
+
+static void create_reduce_types() {
+  if (reduce_type != MPI_DATATYPE_NULL) return;
+  MPI_Type_contiguous(sizeof(ReduceValues), MPI_BYTE, &reduce_type);
+  MPI_Type_commit(&reduce_type);
+  MPI_Op_create(join_values, 1, &reduce_op);
+}
+
+void free_reduce_types() {
+  if (reduce_type == MPI_DATATYPE_NULL) return;
+  MPI_Op_free(&reduce_op);
+  MPI_Type_free(&reduce_type);
+}
+
+GlobalReduce::~GlobalReduce() {
+  if (m_request != MPI_REQUEST_NULL) {
+    MPI_Wait(&m_request, MPI_STATUS_IGNORE);
+  }
+}
+
+void GlobalReduce::start(mpicpp::comm* comm, ReduceValues const& local) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_not_pending(m_request);
+  verify_sizes(local.nmin, local.nsum);
+  m_send = local;
+  m_recv = local;
+  create_reduce_types();
+  MPI_Iallreduce(&m_send, &m_recv, 1, reduce_type, reduce_op, comm->get(), &m_request);
+}
+
+bool GlobalReduce::pending() const {
+  return m_request != MPI_REQUEST_NULL;
+}
+
+ReduceValues const& GlobalReduce::wait() {
+  CALI_CXX_MARK_FUNCTION;
+  if (m_request != MPI_REQUEST_NULL) {
+    MPI_Wait(&m_request, MPI_STATUS_IGNORE);
+  }
+  return m_recv;
+}
+
+ReduceValues reduce(mpicpp::comm* comm, ReduceValues const& local) {
+  GlobalReduce global;
+  global.start(comm, local);
+  return global.wait();
+}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "mpicpp.hpp"
+
+#include "p3a_reduce.hpp"
+
+#include "dgt_pack.hpp"
+
+namespace dgt {
+
+static constexpr int max_reduce = 32;
+
+struct ReduceValues {
+  int nmin = 0;
+  int nsum = 0;
+  double vals[max_reduce] = {};
+};
+
+struct ReduceJoin {
+  [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE
+  ReduceValues operator()(ReduceValues const& a, ReduceValues const& b) const {
+    ReduceValues r = a;
+    for (int i = 0; i < a.nmin; ++i) {
+      r.vals[i] = p3a::min(a.vals[i], b.vals[i]);
+    }
+    for (int i = a.nmin; i < a.nmin + a.nsum; ++i) {
+      r.vals[i] = a.vals[i] + b.vals[i];
+    }
+    return r;
+  }
+};
+
+[[nodiscard]] ReduceValues make_reduce_values(int nmin, int nsum);
+
+template <class ExecutionPolicy, class Functor>
+[[nodiscard]] ReduceValues reduce_block_cells(
+    ExecutionPolicy policy,
+    BlockPack const& pack,
+    ReduceValues const& identity,
+    Functor const& f) {
+  if (pack.nblocks() == 0) return identity;
+  p3a::vector3<int> const n = pack.cell_grid().extents();
+  p3a::grid3 const pack_grid(n.x(), n.y(), n.z() * pack.nblocks());
+  auto functor = [=] P3A_DEVICE (p3a::vector3<int> const& ijk) {
+    int const block = ijk.z() / n.z();
+    p3a::vector3<int> const local(ijk.x(), ijk.y(), ijk.z() - block * n.z());
+    ReduceValues r = identity;
+    f(block, local, r);
+    return r;
+  };
+  return p3a::transform_reduce(policy, pack_grid, identity, ReduceJoin(), functor);
+}
+
+class GlobalReduce {
+  private:
+    ReduceValues m_send;
+    ReduceValues m_recv;
+    MPI_Request m_request = MPI_REQUEST_NULL;
+  public:
+    GlobalReduce() = default;
+    GlobalReduce(GlobalReduce const&) = delete;
+    GlobalReduce& operator=(GlobalReduce const&) = delete;
+    ~GlobalReduce();
+    void start(mpicpp::comm* comm, ReduceValues const& local);
+    [[nodiscard]] bool pending() const;
+    [[nodiscard]] ReduceValues const& wait();
+};
+
+[[nodiscard]] ReduceValues reduce(mpicpp::comm* comm, ReduceValues const& local);
+
+void free_reduce_types();
+
+}
@@ -0,0 +1,112 @@
+#include <stdexcept>
+
+#include "dgt_rk.hpp"
+
+namespace dgt {
+
+static RKStage make_stage(int from, int to, double dt) {
+  RKStage stage;
+  stage.from = from;
+  stage.to = to;
+  stage.dt = dt;
+  return stage;
+}
+
+static RKStage make_stage(
+    int from, int to, double dt,
+    double w00, double w01,
+    double w10, double w11) {
+  RKStage stage = make_stage(from, to, dt);
+  stage.combine = true;
+  stage.weights[0][0] = w00;
+  stage.weights[0][1] = w01;
+  stage.weights[1][0] = w10;
+  stage.weights[1][1] = w11;
+  return stage;
+}
+
+static RKScheme get_ssprk1() {
+  RKScheme scheme;
+  scheme.name = "ssprk1";
+  scheme.order = 1;
+  scheme.nregisters = 1;
+  scheme.ssp_coefficient = 1.;
+  scheme.stages.push_back(make_stage(0, 0, 1.));
+  return scheme;
+}
+
+static RKScheme get_ssprk2() {
+  RKScheme scheme;
+  scheme.name = "ssprk2";
+  scheme.order = 2;
+  scheme.nregisters = 2;
+  scheme.ssp_coefficient = 1.;
+  scheme.stages.push_back(make_stage(0, 1, 1.));
+  scheme.stages.push_back(make_stage(1, 1, 1., 0.5, 0.5, 0., 1.));
+  return scheme;
+}
+
+static RKScheme get_ssprk3() {
+  RKScheme scheme;
+  scheme.name = "ssprk3";
+  scheme.order = 3;
+  scheme.nregisters = 2;
+  scheme.ssp_coefficient = 1.;
+  scheme.stages.push_back(make_stage(0, 1, 1.));
+  scheme.stages.push_back(make_stage(1, 1, 1., 1., 0., 0.75, 0.25));
+  scheme.stages.push_back(make_stage(1, 1, 1., 1./3., 2./3., 0., 1.));
+  return scheme;
+}
+
+// Ketcheson (2008), SSPRK(s,2) in two registers
+static RKScheme get_ssprk_s2(int s) {
+  RKScheme scheme;
+  scheme.name = "ssprk" + std::to_string(s) + "2";
+  scheme.order = 2;
+  scheme.nregisters = 2;
+  scheme.ssp_coefficient = s - 1;
+  double const dt = 1./(s-1);
+  scheme.stages.push_back(make_stage(0, 1, dt));
+  for (int i = 1; i < s-1; ++i) {
+    scheme.stages.push_back(make_stage(1, 1, dt));
+  }
+  scheme.stages.push_back(make_stage(1, 1, dt, 1./s, (s-1.)/s, 0., 1.));
+  return scheme;
+}
+
+// Ketcheson (2008), SSPRK(10,4) in two registers
+static RKScheme get_ssprk104() {
+  RKScheme scheme;
+  scheme.name = "ssprk104";
+  scheme.order = 4;
+  scheme.nregisters = 2;
+  scheme.ssp_coefficient = 6.;
+  double const dt = 1./6.;
+  scheme.stages.push_back(make_stage(0, 1, dt));
+  for (int i = 1; i < 4; ++i) {
+    scheme.stages.push_back(make_stage(1, 1, dt));
+  }
+  scheme.stages.push_back(make_stage(1, 1, dt, 1./25., 9./25., 3./5., 2./5.));
+  for (int i = 5; i < 9; ++i) {
+    scheme.stages.push_back(make_stage(1, 1, dt));
+  }
+  scheme.stages.push_back(make_stage(1, 1, dt, 1., 3./5., 0., 1.));
+  return scheme;
+}
+
+RKScheme get_rk_scheme(std::string const& name) {
+  if (name == "ssprk1") return get_ssprk1();
+  if (name == "ssprk2") return get_ssprk2();
+  if (name == "ssprk3") return get_ssprk3();
+  if (name == "ssprk52") return get_ssprk_s2(5);
+  if (name == "ssprk104") return get_ssprk104();
+  throw std::runtime_error("RK - unknown scheme " + name);
+}
+
+std::string get_default_rk_scheme(int p) {
+  if (p == 0) return "ssprk1";
+  if (p == 1) return "ssprk2";
+  return "ssprk3";
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "p3a_static_array.hpp"
+
+#include "dgt_views.hpp"
+
+namespace dgt {
+
+static constexpr int max_rk_registers = 2;
+
+struct RKStage {
+  int from = 0;
+  int to = 0;
+  double dt = 1.;
+  bool combine = false;
+  double weights[max_rk_registers][max_rk_registers] = {{1.,0.},{0.,1.}};
+};
+
+struct RKScheme {
+  std::string name = "";
+  int order = -1;
+  int nregisters = -1;
+  double ssp_coefficient = -1.;
+  std::vector<RKStage> stages;
+};
+
+[[nodiscard]] RKScheme get_rk_scheme(std::string const& name);
+[[nodiscard]] std::string get_default_rk_scheme(int p);
+
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void combine_registers(
+    RKStage const& stage,
+    int nregisters,
+    p3a::static_array<View<double***>, max_rk_registers> const& U,
+    int cell,
+    int neq,
+    int nmodes) {
+  for (int eq = 0; eq < neq; ++eq) {
+    for (int m = 0; m < nmodes; ++m) {
+      double u[max_rk_registers] = {0., 0.};
+      for (int j = 0; j < nregisters; ++j) {
+        u[j] = U[j](cell, eq, m);
+      }
+      for (int r = 0; r < nregisters; ++r) {
+        double val = 0.;
+        for (int j = 0; j < nregisters; ++j) {
+          val += stage.weights[r][j] * u[j];
+        }
+        U[r](cell, eq, m) = val;
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "p3a_simd_view.hpp"
+
+#include "dgt_basis.hpp"
+
+namespace dgt {
+
+template <bool transpose, class Table, class T>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_contract(
+    Table const& table,
+    int axis,
+    p3a::vector3<int> const& in_bounds,
+    int nout,
+    T const* in,
+    T* out) {
+  p3a::vector3<int> out_bounds = in_bounds;
+  out_bounds[axis] = nout;
+  int const nin = in_bounds[axis];
+  for (int k = 0; k < out_bounds.z(); ++k) {
+    for (int j = 0; j < out_bounds.y(); ++j) {
+      for (int i = 0; i < out_bounds.x(); ++i) {
+        p3a::vector3<int> const ijk(i, j, k);
+        p3a::vector3<int> src = ijk;
+        src[axis] = 0;
+        double const t0 = transpose ? table(0, ijk[axis]) : table(ijk[axis], 0);
+        T val = t0 * in[index(src, in_bounds)];
+        for (int a = 1; a < nin; ++a) {
+          src[axis] = a;
+          double const t = transpose ? table(a, ijk[axis]) : table(ijk[axis], a);
+          val += t * in[index(src, in_bounds)];
+        }
+        out[index(ijk, out_bounds)] = val;
+      }
+    }
+  }
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_gather(
+    View<double***> U, BasisT const& b,
+    int cell, int eq, double* c) {
+  for (int t = 0; t < O::nmodes; ++t) {
+    c[t] = U(cell, eq, b.tensor_mode(t));
+  }
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_gather(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int eq, p3a::device_simd<double>* c,
+    p3a::device_simd_mask<double> const& mask) {
+  for (int t = 0; t < O::nmodes; ++t) {
+    c[t] = U.load(cell, eq, b.tensor_mode(t), mask);
+  }
+}
+
+template <class O, class BasisT, class T>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_interp_modes(BasisT const& b, T* vals) {
+  static_assert(O::tensor, "tensor_interp_modes requires a tensor basis");
+  int constexpr n = O::p + 1;
+  T tmp[O::nmodes];
+  T* in = vals;
+  T* out = tmp;
+  p3a::vector3<int> const bounds = tensor_bounds(O::dim, O::p);
+  auto phi = [&] (int pt, int deg) { return b.phi_1d(pt, deg); };
+  for (int axis = 0; axis < O::dim; ++axis) {
+    tensor_contract<false>(phi, axis, bounds, n, in, out);
+    T* const swap = in; in = out; out = swap;
+  }
+  if (in != vals) {
+    for (int pt = 0; pt < O::nintr_pts; ++pt) vals[pt] = in[pt];
+  }
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_interp_intr(
+    View<double***> U, BasisT const& b,
+    int cell, int eq, double* vals) {
+  tensor_gather<O>(U, b, cell, eq, vals);
+  tensor_interp_modes<O>(b, vals);
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_interp_intr(
+    p3a::simd_view<double***> U, BasisT const& b,
+    int cell, int eq, p3a::device_simd<double>* vals,
+    p3a::device_simd_mask<double> const& mask) {
+  tensor_gather<O>(U, b, cell, eq, vals, mask);
+  tensor_interp_modes<O>(b, vals);
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_interp_child_intr(
+    View<double***> U, BasisT const& b,
+    int cell, p3a::vector3<int> const& local, int eq, double* vals) {
+  static_assert(O::tensor, "tensor_interp_child_intr requires a tensor basis");
+  int constexpr n = O::p + 1;
+  double tmp[O::nmodes];
+  double* in = vals;
+  double* out = tmp;
+  p3a::vector3<int> const bounds = tensor_bounds(O::dim, O::p);
+  tensor_gather<O>(U, b, cell, eq, in);
+  for (int axis = 0; axis < O::dim; ++axis) {
+    int const which_child = local[axis];
+    auto phi = [&] (int pt, int deg) { return b.phi_child_1d(which_child, pt, deg); };
+    tensor_contract<false>(phi, axis, bounds, n, in, out);
+    double* const swap = in; in = out; out = swap;
+  }
+  if (in != vals) {
+    for (int pt = 0; pt < O::nintr_pts; ++pt) vals[pt] = in[pt];
+  }
+}
+
+template <class O, class BasisT>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_interp_side(
+    BasisT const& b, double const* c,
+    int axis, int dir, double* vals) {
+  static_assert(O::tensor, "tensor_interp_side requires a tensor basis");
+  int constexpr n = O::p + 1;
+  double buf[2][O::nmodes];
+  double* in = buf[0];
+  double* out = buf[1];
+  p3a::vector3<int> bounds = tensor_bounds(O::dim, O::p);
+  auto phi_side = [&] (int, int deg) { return b.phi_side_1d(dir, deg); };
+  auto phi = [&] (int pt, int deg) { return b.phi_1d(pt, deg); };
+  tensor_contract<false>(phi_side, axis, bounds, 1, c, in);
+  bounds[axis] = 1;
+  for (int d = 0; d < O::dim; ++d) {
+    if (d == axis) continue;
+    tensor_contract<false>(phi, d, bounds, n, in, out);
+    double* const swap = in; in = out; out = swap;
+  }
+  for (int pt = 0; pt < O::nside_pts; ++pt) vals[pt] = in[pt];
+}
+
+template <class O, class BasisT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double tensor_min_side(
+    View<double***> U, BasisT const& b,
+    int cell, int axis, int dir, int eq) {
+  double c[O::nmodes];
+  double vals[O::nside_pts];
+  tensor_gather<O>(U, b, cell, eq, c);
+  tensor_interp_side<O>(b, c, axis, dir, vals);
+  double min_val = vals[0];
+  for (int pt = 1; pt < O::nside_pts; ++pt) {
+    min_val = p3a::min(min_val, vals[pt]);
+  }
+  return min_val;
+}
+
+template <class O, class BasisT, class T>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void tensor_integrate_intr(
+    BasisT const& b, int deriv_axis, T* vals, T* r) {
+  static_assert(O::tensor, "tensor_integrate_intr requires a tensor basis");
+  int constexpr n = O::p + 1;
+  T* in = vals;
+  T* out = r;
+  p3a::vector3<int> const bounds = tensor_bounds(O::dim, O::p);
+  for (int axis = 0; axis < O::dim; ++axis) {
+    auto phi = [&] (int pt, int deg) {
+      return (axis == deriv_axis) ? b.dphi_1d(pt, deg) : b.phi_1d(pt, deg);
+    };
+    tensor_contract<true>(phi, axis, bounds, n, in, out);
+    T* const swap = in; in = out; out = swap;
+  }
+  if (in != r) {
+    for (int t = 0; t < O::nmodes; ++t) r[t] = in[t];
+  }
+}
+
+}
@@ -0,0 +1,93 @@
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "dgt_dispatch.hpp"
+#include "dgt_grid.hpp"
+#include "dgt_interp.hpp"
+#include "dgt_tensor.hpp"
+#include "dgt_trace.hpp"
+
+namespace dgt {
+
+static void verify_traces(Mesh const& mesh) {
+  for (Node* leaf : mesh.owned_leaves()) {
+    if (!has_traces(leaf->block)) {
+      throw std::runtime_error("compute_traces - missing trace field");
+    }
+  }
+}
+
+int get_ntrace_comps(int dim, int p, int neq) {
+  return dim * ndirs * num_pts(dim-1, p) * neq;
+}
+
+void add_trace_field(Mesh& mesh, int p) {
+  int const dim = get_dim(mesh.cell_grid());
+  mesh.add_field(trace_field, dim, get_ntrace_comps(dim, p, mesh.nmodal_eq()));
+}
+
+bool has_traces(Block const& block) {
+  return block.field_idx(trace_field) >= 0;
+}
+
+template <class O>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void compute_cell_traces(
+    View<double***> U, UnmanagedView<double**> T,
+    BasisTable const& b, int cell, int dim, int neq) {
+  int constexpr npts = O::nside_pts;
+  if constexpr (O::tensor) {
+    for (int eq = 0; eq < neq; ++eq) {
+      double c[O::nmodes];
+      double vals[npts];
+      tensor_gather<O>(U, b, cell, eq, c);
+      for (int axis = 0; axis < dim; ++axis) {
+        for (int dir = 0; dir < ndirs; ++dir) {
+          tensor_interp_side<O>(b, c, axis, dir, vals);
+          for (int pt = 0; pt < npts; ++pt) {
+            T(cell, get_trace_comp(axis, dir, pt, eq, npts, neq)) = vals[pt];
+          }
+        }
+      }
+    }
+  } else {
+    for (int axis = 0; axis < dim; ++axis) {
+      for (int dir = 0; dir < ndirs; ++dir) {
+        for (int pt = 0; pt < npts; ++pt) {
+          for (int eq = 0; eq < neq; ++eq) {
+            int const comp = get_trace_comp(axis, dir, pt, eq, npts, neq);
+            T(cell, comp) = interp_scalar_side<O::nmodes>(U, b, cell, axis, dir, pt, eq);
+          }
+        }
+      }
+    }
+  }
+}
+
+template <class O>
+static void compute_traces(Mesh const& mesh, int soln_idx) {
+  BlockPack const pack = mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  BasisTable const b = mesh.basis().table;
+  int const dim = pack.dim();
+  int const neq = pack.nmodal_eq();
+  auto f = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+    View<double***> const U = pack.soln(block, soln_idx);
+    UnmanagedView<double**> const T = pack.trace(block);
+    int const cell = cell_grid.index(cell_ijk);
+    compute_cell_traces<O>(U, T, b, cell, dim, neq);
+  };
+  for_each_block_cell(p3a::execution::par, pack, f);
+}
+
+void compute_traces(Mesh& mesh, int soln_idx) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_traces(mesh);
+  auto f = [&] (auto order) {
+    compute_traces<decltype(order)>(mesh, soln_idx);
+  };
+  dispatch(mesh.basis(), f);
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "p3a_simd_view.hpp"
+#include "p3a_static_vector.hpp"
+
+#include "dgt_mesh.hpp"
+
+namespace dgt {
+
+static constexpr char const* trace_field = "trace";
+
+[[nodiscard]] int get_ntrace_comps(int dim, int p, int neq);
+
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+int get_trace_comp(int axis, int dir, int pt, int eq, int nside_pts, int neq) {
+  return ((axis * ndirs + dir) * nside_pts + pt) * neq + eq;
+}
+
+template <int neq, class ViewT>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<double, neq> gather_trace(
+    ViewT T, int cell, int axis, int dir, int pt, int nside_pts) {
+  p3a::static_vector<double, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = T(cell, get_trace_comp(axis, dir, pt, eq, nside_pts, neq));
+  }
+  return val;
+}
+
+template <int neq>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<p3a::device_simd<double>, neq> gather_trace(
+    p3a::simd_view<double***> T, int cell, int axis, int dir, int pt, int nside_pts,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::static_vector<p3a::device_simd<double>, neq> val;
+  for (int eq = 0; eq < neq; ++eq) {
+    val[eq] = T.load(cell, get_trace_comp(axis, dir, pt, eq, nside_pts, neq), 0, mask);
+  }
+  return val;
+}
+
+void add_trace_field(Mesh& mesh, int p);
+[[nodiscard]] bool has_traces(Block const& block);
+void compute_traces(Mesh& mesh, int soln_idx);
+
+}
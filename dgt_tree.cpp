@@ -1,3 +1,5 @@
+#include <stdexcept>
+
 #include "mpicpp.hpp"
 
 #include "p3a_for_each.hpp"
@@ -198,4 +200,71 @@ std::vector<Node*> collect_owned_leaves(
   return owned_leaves;
 }
 
+static void set_bit(std::vector<std::uint8_t>& bits, std::size_t idx, bool value) {
+  if ((idx / 8) >= bits.size()) bits.push_back(0);
+  if (value) bits[idx / 8] |= std::uint8_t(1 << (idx % 8));
+}
+
+static bool get_bit(std::vector<std::uint8_t> const& bits, std::size_t idx) {
+  if ((idx / 8) >= bits.size()) {
+    throw std::runtime_error("decode_tree - truncated bit stream");
+  }
+  return (bits[idx / 8] >> (idx % 8)) & 1;
+}
+
+static void verify_consumed(std::vector<std::uint8_t> const& bits, std::size_t idx) {
+  if (bits.size() * 8 - idx > 7) {
+    throw std::runtime_error("decode_tree - trailing bits in bit stream");
+  }
+}
+
+static void encode_node(
+    int dim,
+    int base_depth,
+    Node const* node,
+    std::vector<std::uint8_t>& bits,
+    std::size_t& idx) {
+  if (node->pt().depth >= base_depth) {
+    set_bit(bits, idx++, !node->is_leaf());
+  }
+  auto f = [&] (p3a::vector3<int> const& local) {
+    Node const* child = node->child(local);
+    if (child) encode_node(dim, base_depth, child, bits, idx);
+  };
+  p3a::for_each(p3a::execution::seq, generalize(get_child_grid(dim)), f);
+}
+
+static void decode_node(
+    int dim,
+    int base_depth,
+    Node* node,
+    std::vector<std::uint8_t> const& bits,
+    std::size_t& idx) {
+  p3a::grid3 const child_grid = generalize(get_child_grid(dim));
+  if ((node->pt().depth >= base_depth) && get_bit(bits, idx++)) {
+    auto add = [&] (p3a::vector3<int> const& local) { node->add_child(local); };
+    p3a::for_each(p3a::execution::seq, child_grid, add);
+  }
+  auto f = [&] (p3a::vector3<int> const& local) {
+    Node* child = node->child(local);
+    if (child) decode_node(dim, base_depth, child, bits, idx);
+  };
+  p3a::for_each(p3a::execution::seq, child_grid, f);
+}
+
+std::vector<std::uint8_t> encode_tree(Tree const& tree) {
+  CALI_CXX_MARK_FUNCTION;
+  std::size_t idx = 0;
+  std::vector<std::uint8_t> bits;
+  encode_node(tree.dim(), tree.base().depth, tree.root(), bits, idx);
+  return bits;
+}
+
+void decode_tree(Tree& tree, std::vector<std::uint8_t> const& bits) {
+  CALI_CXX_MARK_FUNCTION;
+  std::size_t idx = 0;
+  decode_node(tree.dim(), tree.base().depth, tree.root(), bits, idx);
+  verify_consumed(bits, idx);
+}
+
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "mpicpp.hpp"
 
 #include "p3a_grid3.hpp"
@@ -63,6 +66,9 @@ class Tree {
 
 std::vector<Node*> collect_leaves(Tree& tree);
 
+std::vector<std::uint8_t> encode_tree(Tree const& tree);
+void decode_tree(Tree& tree, std::vector<std::uint8_t> const& bits);
+
 void partition_leaves(
     mpicpp::comm* comm,
     std::vector<Node*> const& leaves);
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <stdexcept>
+
+#include "caliper/cali.h"
+
+#include "p3a_reduce.hpp"
+
+#include "dgt_vector.hpp"
+
+namespace dgt {
+
+static void verify_idx(Mesh const& mesh, int idx) {
+  if ((idx < 0) || (idx >= mesh.nsoln())) {
+    throw std::runtime_error("MeshVector - invalid soln index");
+  }
+}
+
+static void verify_mesh(MeshVector const& x, MeshVector const& y) {
+  if (&x.mesh() != &y.mesh()) {
+    throw std::runtime_error("MeshVector - vectors on different meshes");
+  }
+}
+
+static void verify_combine(
+    std::vector<double> const& a,
+    std::vector<MeshVector> const& x) {
+  if ((a.size() != x.size()) || (x.size() < 1) || (x.size() > max_nsoln)) {
+    throw std::runtime_error("MeshVector - invalid combination");
+  }
+}
+
+MeshVector::MeshVector(Mesh const& mesh, int idx) :
+  m_mesh(&mesh),
+  m_idx(idx) {
+  verify_idx(mesh, idx);
+}
+
+Mesh const& MeshVector::mesh() const {
+  return *m_mesh;
+}
+
+int MeshVector::idx() const {
+  return m_idx;
+}
+
+static int get_nentries(BlockPack const& pack) {
+  return pack.cell_grid().size() * pack.nmodal_eq() * pack.nmodes();
+}
+
+template <class Functor, class BinaryOp>
+static double reduce_entries(
+    BlockPack const& pack,
+    double identity,
+    BinaryOp const& binary_op,
+    Functor const& f) {
+  int const nentries = get_nentries(pack);
+  int const n = pack.nblocks() * nentries;
+  auto functor = [=] P3A_DEVICE (int const i) {
+    int const block = i / nentries;
+    return f(pack.block(block), i - block * nentries);
+  };
+  return p3a::transform_reduce(
+      p3a::execution::par,
+      p3a::counting_iterator(0),
+      p3a::counting_iterator(n),
+      identity,
+      binary_op,
+      functor);
+}
+
+void axpby(
+    MeshVector const& r,
+    double a,
+    MeshVector const& x,
+    double b,
+    MeshVector const& y) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_mesh(r, x);
+  verify_mesh(r, y);
+  BlockPack const pack = r.mesh().pack();
+  int const r_idx = r.idx();
+  int const x_idx = x.idx();
+  int const y_idx = y.idx();
+  auto f = [=] P3A_DEVICE (int const block, int const i) {
+    PackedBlock const& pb = pack.block(block);
+    pb.soln[r_idx][i] = a * pb.soln[x_idx][i] + b * pb.soln[y_idx][i];
+  };
+  for_each_block_entry(p3a::execution::par, pack, get_nentries(pack), f);
+}
+
+void combine(
+    MeshVector const& r,
+    std::vector<double> const& a,
+    std::vector<MeshVector> const& x) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_combine(a, x);
+  int const k = x.size();
+  double weights[max_nsoln] = {};
+  int idx[max_nsoln] = {};
+  for (int j = 0; j < k; ++j) {
+    verify_mesh(r, x[j]);
+    weights[j] = a[j];
+    idx[j] = x[j].idx();
+  }
+  BlockPack const pack = r.mesh().pack();
+  int const r_idx = r.idx();
+  auto f = [=] P3A_DEVICE (int const block, int const i) {
+    PackedBlock const& pb = pack.block(block);
+    double val = 0.;
+    for (int j = 0; j < k; ++j) {
+      val += weights[j] * pb.soln[idx[j]][i];
+    }
+    pb.soln[r_idx][i] = val;
+  };
+  for_each_block_entry(p3a::execution::par, pack, get_nentries(pack), f);
+}
+
+double dot(MeshVector const& x, MeshVector const& y) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_mesh(x, y);
+  BlockPack const pack = x.mesh().pack();
+  int const x_idx = x.idx();
+  int const y_idx = y.idx();
+  auto f = [=] P3A_DEVICE (PackedBlock const& pb, int const i) {
+    return pb.soln[x_idx][i] * pb.soln[y_idx][i];
+  };
+  double result = reduce_entries(pack, 0., p3a::adder<double>(), f);
+  mpicpp::request req = x.mesh().comm()->iallreduce(&result, 1, mpicpp::op::sum());
+  req.wait();
+  return result;
+}
+
+double norm_1(MeshVector const& x) {
+  CALI_CXX_MARK_FUNCTION;
+  BlockPack const pack = x.mesh().pack();
+  int const x_idx = x.idx();
+  auto f = [=] P3A_DEVICE (PackedBlock const& pb, int const i) {
+    return std::abs(pb.soln[x_idx][i]);
+  };
+  double result = reduce_entries(pack, 0., p3a::adder<double>(), f);
+  mpicpp::request req = x.mesh().comm()->iallreduce(&result, 1, mpicpp::op::sum());
+  req.wait();
+  return result;
+}
+
+double norm_2(MeshVector const& x) {
+  return std::sqrt(dot(x, x));
+}
+
+double norm_inf(MeshVector const& x) {
+  CALI_CXX_MARK_FUNCTION;
+  BlockPack const pack = x.mesh().pack();
+  int const x_idx = x.idx();
+  auto f = [=] P3A_DEVICE (PackedBlock const& pb, int const i) {
+    return std::abs(pb.soln[x_idx][i]);
+  };
+  double result = reduce_entries(pack, 0., p3a::maximizer<double>(), f);
+  mpicpp::request req = x.mesh().comm()->iallreduce(&result, 1, mpicpp::op::max());
+  req.wait();
+  return result;
+}
+
+}
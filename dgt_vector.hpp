@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+#include "dgt_mesh.hpp"
+
+namespace dgt {
+
+class MeshVector {
+  private:
+    Mesh const* m_mesh = nullptr;
+    int m_idx = -1;
+  public:
+    MeshVector() = default;
+    MeshVector(Mesh const& mesh, int idx);
+    [[nodiscard]] Mesh const& mesh() const;
+    [[nodiscard]] int idx() const;
+};
+
+void axpby(
+    MeshVector const& r,
+    double a,
+    MeshVector const& x,
+    double b,
+    MeshVector const& y);
+
+void combine(
+    MeshVector const& r,
+    std::vector<double> const& a,
+    std::vector<MeshVector> const& x);
+
+[[nodiscard]] double dot(MeshVector const& x, MeshVector const& y);
+[[nodiscard]] double norm_1(MeshVector const& x);
+[[nodiscard]] double norm_2(MeshVector const& x);
+[[nodiscard]] double norm_inf(MeshVector const& x);
+
+}
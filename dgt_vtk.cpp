@@ -1,5 +1,14 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 #include "zlib.h"
 
@@ -16,14 +25,19 @@ namespace dgt {
 namespace vtk {
 
 template <class T> std::string vtk_type_name();
+template <> std::string vtk_type_name<std::int8_t>() { return "Int8"; }
 template <> std::string vtk_type_name<int>() { return "Int32"; }
 template <> std::string vtk_type_name<float>() { return "Float32"; }
 template <> std::string vtk_type_name<double>() { return "Float64"; }
 
-static void write_vtr_header(std::stringstream& stream) {
+static void write_vtr_header(
+    std::stringstream& stream,
+    Compression const& compression) {
   stream << "<VTKFile type=\"RectilinearGrid\" ";
   stream << "version=\"1.0\" ";
-  stream << "compressor=\"vtkZLibDataCompressor\" ";
+  if (compression.enabled) {
+    stream << "compressor=\"vtkZLibDataCompressor\" ";
+  }
   stream << "header_type=\"UInt64\">\n";
 }
 
@@ -56,12 +70,18 @@ static void write_data_start(
     std::stringstream& stream,
     std::string const& type,
     std::string const& name,
-    int ncomps) {
+    int ncomps,
+    AppendedData const* appended = nullptr) {
   stream << "<";
   stream << "DataArray type=\"" << type << "\" ";
   stream << "Name=\"" << name << "\" ";
   stream << "NumberOfComponents=\"" << ncomps << "\" ";
-  stream << "format=\"binary\"";
+  if (appended) {
+    stream << "format=\"appended\" ";
+    stream << "offset=\"" << appended->nbytes << "\"";
+  } else {
+    stream << "format=\"binary\"";
+  }
   stream << ">\n";
 }
 
@@ -139,73 +159,229 @@ static void write_piece_start(std::stringstream& stream, Block const& block) {
   stream << "0 " << n.z() << "\">\n";
 }
 
+static void verify_compression(Compression const& c) {
+  if ((c.level < 0) || (c.level > 9)) {
+    throw std::runtime_error("vtk - invalid compression level");
+  }
+  if (c.block_size < 1) {
+    throw std::runtime_error("vtk - invalid compression block size");
+  }
+}
+
+static void verify_nthreads(int nthreads) {
+  if (nthreads < 1) {
+    throw std::runtime_error("vtk - invalid compression thread count");
+  }
+}
+
+static int get_nthreads(Compression const& c, std::uint64_t nblocks) {
+  verify_nthreads(c.nthreads);
+  return int(std::min(std::uint64_t(c.nthreads), nblocks));
+}
+
+class WorkerPool {
+  private:
+    bool m_stop = false;
+    std::deque<std::function<void()>> m_jobs;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    void work() {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (true) {
+        m_cv.wait(lock, [this] () { return m_stop || !m_jobs.empty(); });
+        if (m_jobs.empty()) return;
+        std::function<void()> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        lock.unlock();
+        job();
+        lock.lock();
+      }
+    }
+  public:
+    WorkerPool() = default;
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+    ~WorkerPool() {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_stop = true;
+      }
+      m_cv.notify_all();
+      for (std::thread& thread : m_threads) thread.join();
+    }
+    void run(int njobs, std::function<void(int)> const& job) {
+      int remaining = njobs - 1;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (int(m_threads.size()) < njobs - 1) {
+          m_threads.emplace_back([this] () { work(); });
+        }
+        for (int t = 1; t < njobs; ++t) {
+          m_jobs.push_back([&, t] () {
+            job(t);
+            std::unique_lock<std::mutex> done_lock(m_mutex);
+            if (--remaining == 0) m_cv.notify_all();
+          });
+        }
+      }
+      m_cv.notify_all();
+      job(0);
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cv.wait(lock, [&] () { return remaining == 0; });
+    }
+};
+
+static WorkerPool& get_worker_pool() {
+  static WorkerPool pool;
+  return pool;
+}
+
+static std::vector<std::uint64_t> compress(
+    void const* data,
+    std::uint64_t bytes,
+    Compression const& c,
+    std::vector<char>& out) {
+  CALI_CXX_MARK_FUNCTION;
+  verify_compression(c);
+  std::uint64_t const nblocks = (bytes + c.block_size - 1) / c.block_size;
+  std::vector<std::vector<char>> blocks(nblocks);
+  std::atomic<bool> failed(false);
+  auto compress_block = [&] (std::uint64_t b) {
+    std::uint64_t const offset = b * c.block_size;
+    uLong const source_bytes = std::min(c.block_size, bytes - offset);
+    uLong dest_bytes = ::compressBound(source_bytes);
+    blocks[b].resize(dest_bytes);
+    int ret = ::compress2(reinterpret_cast<::Bytef*>(blocks[b].data()), &dest_bytes,
+        reinterpret_cast<const ::Bytef*>(data) + offset,
+        source_bytes, c.level);
+    if (ret != Z_OK) failed = true;
+    blocks[b].resize(dest_bytes);
+  };
+  int const nthreads = get_nthreads(c, nblocks);
+  if (nthreads > 1) {
+    auto compress_stride = [&] (int t) {
+      for (std::uint64_t b = t; b < nblocks; b += nthreads) compress_block(b);
+    };
+    get_worker_pool().run(nthreads, compress_stride);
+  } else {
+    for (std::uint64_t b = 0; b < nblocks; ++b) compress_block(b);
+  }
+  if (failed) throw std::runtime_error("vtk - zlib error");
+  std::vector<std::uint64_t> header = {nblocks, c.block_size, bytes % c.block_size};
+  for (std::vector<char> const& block : blocks) {
+    header.push_back(block.size());
+    out.insert(out.end(), block.begin(), block.end());
+  }
+  return header;
+}
+
 template <class T>
 void write_data(
     std::stringstream& stream,
     VizView<T> dual,
-    bool copy = true) {
+    bool copy = true,
+    AppendedData* appended = nullptr) {
+  Compression const compression = appended ? appended->compression : Compression();
   if (copy) dual.template sync<typename VizView<T>::host_mirror_space>();
   auto field = dual.h_view;
   std::uint64_t uncompressed_bytes = sizeof(T) * static_cast<uint64_t>(field.size());
-  uLong source_bytes = uncompressed_bytes;
-  uLong dest_bytes = ::compressBound(source_bytes);
-  auto compressed = new ::Bytef[dest_bytes];
-  int ret = ::compress2(compressed, &dest_bytes,
-      reinterpret_cast<const ::Bytef*>(field.data()),
-      source_bytes, Z_BEST_SPEED);
-  if (ret != Z_OK) throw std::runtime_error("vtk - zlib error");
-  std::string const encoded = base64::encode(compressed, dest_bytes);
-  delete[] compressed;
-  std::uint64_t header[4] = {1, uncompressed_bytes, uncompressed_bytes, dest_bytes};
-  std::string const enc_header = base64::encode(header, sizeof(header));
+  char const* bytes = reinterpret_cast<char const*>(field.data());
+  std::vector<std::uint64_t> header = {uncompressed_bytes};
+  std::vector<char> data;
+  if (compression.enabled) {
+    header = compress(field.data(), uncompressed_bytes, compression, data);
+  } else {
+    data.assign(bytes, bytes + uncompressed_bytes);
+  }
+  std::size_t const header_bytes = header.size() * sizeof(std::uint64_t);
+  if (appended) {
+    std::string array(header_bytes + data.size(), '\0');
+    std::memcpy(array.data(), header.data(), header_bytes);
+    std::memcpy(array.data() + header_bytes, data.data(), data.size());
+    appended->nbytes += array.size();
+    appended->arrays.push_back(std::move(array));
+    return;
+  }
+  std::string const enc_header = base64::encode(header.data(), header_bytes);
+  std::string const encoded = base64::encode(data.data(), data.size());
   stream.write(enc_header.data(), std::streamsize(enc_header.length()));
   stream.write(encoded.data(), std::streamsize(encoded.length()));
   stream.write("\n", 1);
 }
 
-static void write_coordinate(std::stringstream& stream, Block const& block, int axis) {
-  std::string const axis_name[DIMS] = {"x", "y", "z"};
-  int const p = block.basis().p;
-  int const num_pts = (p+1)*block.cell_grid().extents()[axis] + 1;
+static double get_viz_coord(Block const& block, int p, int axis, int i) {
   double const o = block.domain().lower()[axis];
   double const dx = block.dx()[axis] / (p+1);
-  VizView<float> coord;
-  Kokkos::resize(coord, num_pts, 1);
   double const offset[max_p+1][max_p+1] = {
     {0.,  0.,    0.},
     {0.,  0.,    0.},
     {0., -2./9., 2./9.}
   };
+  int const mod = i%(p+1);
+  return o + i*dx + offset[p][mod]*dx;
+}
+
+static void write_coordinate(
+    std::stringstream& stream,
+    Block const& block,
+    int axis,
+    AppendedData* appended) {
+  std::string const axis_name[DIMS] = {"x", "y", "z"};
+  int const p = block.basis().p;
+  int const num_pts = (p+1)*block.cell_grid().extents()[axis] + 1;
+  VizView<float> coord;
+  Kokkos::resize(coord, num_pts, 1);
   for (int i = 0; i < num_pts; ++i) {
-    int const mod = i%(p+1);
-    coord.h_view(i, 0) = o + i*dx + offset[p][mod]*dx;
+    coord.h_view(i, 0) = get_viz_coord(block, p, axis, i);
   }
-  write_data_start(stream, "Float32", axis_name[axis], 1);
-  write_data(stream, coord, false);
+  write_data_start(stream, "Float32", axis_name[axis], 1, appended);
+  write_data(stream, coord, false, appended);
   write_data_end(stream);
 }
 
-static void write_coordinates(std::stringstream& stream, Block const& block) {
+static void write_coordinates(
+    std::stringstream& stream,
+    Block const& block,
+    AppendedData* appended) {
   stream << "<Coordinates>\n";
-  write_coordinate(stream, block, X);
-  write_coordinate(stream, block, Y);
-  write_coordinate(stream, block, Z);
+  write_coordinate(stream, block, X, appended);
+  write_coordinate(stream, block, Y, appended);
+  write_coordinate(stream, block, Z, appended);
   stream << "</Coordinates>\n";
 }
 
-void write_vtr_start(
+static void write_vtr_start(
     std::stringstream& stream,
     Block const& block,
     double time,
-    int step) {
-  write_vtr_header(stream);
+    int step,
+    AppendedData* appended) {
+  write_vtr_header(stream, appended ? appended->compression : Compression());
   write_vtr_rectilinear_start(stream, block);
   write_vtr_field_data(stream, block, time, step);
   write_piece_start(stream, block);
-  write_coordinates(stream, block);
+  write_coordinates(stream, block, appended);
   stream << "<CellData>\n";
 }
 
+void write_vtr_start(
+    std::stringstream& stream,
+    Block const& block,
+    double time,
+    int step) {
+  write_vtr_start(stream, block, time, step, nullptr);
+}
+
+void write_vtr_start(
+    std::stringstream& stream,
+    Block const& block,
+    double time,
+    int step,
+    AppendedData& appended) {
+  write_vtr_start(stream, block, time, step, &appended);
+}
+
 template <class T>
 void write_field(
     std::stringstream& stream,
@@ -218,17 +394,57 @@ void write_field(
   write_data_end(stream);
 }
 
+template <class T>
+void write_field(
+    std::stringstream& stream,
+    std::string const& name,
+    VizView<T> f,
+    AppendedData& appended) {
+  CALI_CXX_MARK_FUNCTION;
+  int const ncomps = f.d_view.extent(1);
+  write_data_start(stream, vtk_type_name<T>(), name, ncomps, &appended);
+  write_data(stream, f, true, &appended);
+  write_data_end(stream);
+}
+
 template void write_field<int>(std::stringstream&, std::string const&, VizView<int> f);
 template void write_field<float>(std::stringstream&, std::string const&, VizView<float> f);
 template void write_field<double>(std::stringstream&, std::string const&, VizView<double> f);
+template void write_field<int>(std::stringstream&, std::string const&, VizView<int> f, AppendedData&);
+template void write_field<float>(std::stringstream&, std::string const&, VizView<float> f, AppendedData&);
+template void write_field<double>(std::stringstream&, std::string const&, VizView<double> f, AppendedData&);
 
-void write_vtr_end(std::stringstream& stream) {
+static void write_vtr_close(std::stringstream& stream) {
   stream << "</CellData>\n";
   stream << "</Piece>\n";
   stream << "</RectilinearGrid>\n";
+}
+
+void write_vtr_end(std::stringstream& stream) {
+  write_vtr_close(stream);
   stream << "</VTKFile>\n";
 }
 
+void write_vtr_end(
+    std::filesystem::path const& path,
+    std::stringstream& stream,
+    AppendedData const& appended) {
+  CALI_CXX_MARK_FUNCTION;
+  write_vtr_close(stream);
+  std::ofstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("vtk - could not open: " + path.string());
+  }
+  file << stream.rdbuf();
+  file << "<AppendedData encoding=\"raw\">\n_";
+  for (std::string const& array : appended.arrays) {
+    file.write(array.data(), std::streamsize(array.size()));
+  }
+  file << "\n</AppendedData>\n";
+  file << "</VTKFile>\n";
+  file.close();
+}
+
 static void write_vtm_header(std::stringstream& stream) {
   stream << "<VTKFile type=\"vtkMultiBlockDataSet\" ";
   stream << "version=\"1.0\">\n";
@@ -248,19 +464,28 @@ static void write_vtm_source_file(
   stream << "file=\"" << file << "\"/>\n";
 }
 
-void write_vtm(std::stringstream& stream, std::string const& prefix, int nblocks) {
+void write_vtm(
+    std::stringstream& stream,
+    std::string const& prefix,
+    int nblocks,
+    std::string const& extension) {
   write_vtm_header(stream);
   for (int i = 0; i < nblocks; ++i) {
-    std::string const file = prefix + std::to_string(i) + ".vtr";
+    std::string const file = prefix + std::to_string(i) + extension;
     write_vtm_source_file(stream, i, file);
   }
   write_vtm_end(stream);
 }
 
-static void write_vtu_header(std::stringstream& out) {
+static void write_vtu_header(
+    std::stringstream& out,
+    Compression const& compression = Compression()) {
   out << "<VTKFile type=\"UnstructuredGrid\" ";
-  out << "header_type=\"UInt64\" ";
-  out << "compressor=\"vtkZLibDataCompressor\">\n";
+  out << "header_type=\"UInt64\"";
+  if (compression.enabled) {
+    out << " compressor=\"vtkZLibDataCompressor\"";
+  }
+  out << ">\n";
 }
 
 static void write_tree_types(std::stringstream& stream, int dim, int num) {
@@ -407,4 +632,284 @@ void write_tree(
 
 }
 
+template <class T>
+static void add_vtu_array(
+    VtuPiece& piece,
+    std::string const& section,
+    std::string const& name,
+    VizView<T> dual,
+    bool copy) {
+  std::stringstream unused;
+  int const ncomps = dual.h_view.extent(1);
+  piece.arrays.push_back({section, vtk_type_name<T>(), name, ncomps, piece.data.nbytes});
+  write_data(unused, dual, copy, &piece.data);
+}
+
+static int get_viz_p(Block const& block, bool averages) {
+  return averages ? 0 : block.basis().p;
+}
+
+static p3a::grid3 get_viz_node_grid(p3a::grid3 const& viz_grid, int dim) {
+  p3a::vector3<int> n = viz_grid.extents();
+  for (int axis = 0; axis < dim; ++axis) {
+    n[axis] += 1;
+  }
+  return p3a::grid3(n);
+}
+
+static void add_vtu_points(
+    VtuPiece& piece,
+    std::vector<Block const*> const& blocks,
+    int dim,
+    bool averages) {
+  VizView<float> coords;
+  Kokkos::resize(coords, piece.npoints, DIMS);
+  int offset = 0;
+  for (Block const* block : blocks) {
+    p3a::grid3 const g = block->cell_grid();
+    int const p = get_viz_p(*block, averages);
+    p3a::grid3 const viz_grid = generalize(get_viz_cell_grid(g, p));
+    p3a::grid3 const node_grid = get_viz_node_grid(viz_grid, dim);
+    auto f = [&] (p3a::vector3<int> const& node) {
+      int const point = offset + node_grid.index(node);
+      for (int axis = 0; axis < DIMS; ++axis) {
+        coords.h_view(point, axis) = (axis < dim) ?
+          get_viz_coord(*block, p, axis, node[axis]) : 0.f;
+      }
+    };
+    p3a::for_each(p3a::execution::seq, node_grid, f);
+    offset += node_grid.size();
+  }
+  add_vtu_array(piece, "Points", "coordinates", coords, false);
+}
+
+static void add_vtu_cells(
+    VtuPiece& piece,
+    std::vector<Block const*> const& blocks,
+    int dim,
+    int ncorners,
+    bool averages) {
+  static constexpr std::int8_t vtk_types[] = {1,3,9,12};
+  VizView<int> connectivity;
+  VizView<int> offsets;
+  VizView<std::int8_t> types;
+  Kokkos::resize(connectivity, piece.ncells * ncorners, 1);
+  Kokkos::resize(offsets, piece.ncells, 1);
+  Kokkos::resize(types, piece.ncells, 1);
+  int cell_offset = 0;
+  int point_offset = 0;
+  for (Block const* block : blocks) {
+    p3a::grid3 const g = block->cell_grid();
+    p3a::grid3 const viz_grid = generalize(get_viz_cell_grid(g, get_viz_p(*block, averages)));
+    p3a::grid3 const node_grid = get_viz_node_grid(viz_grid, dim);
+    auto f = [&] (p3a::vector3<int> const& ijk) {
+      int const cell = cell_offset + viz_grid.index(ijk);
+      for (int c = 0; c < ncorners; ++c) {
+        connectivity.h_view(cell * ncorners + c, 0) =
+          point_offset + node_grid.index(ijk + vtk_corners[c]);
+      }
+    };
+    p3a::for_each(p3a::execution::seq, viz_grid, f);
+    cell_offset += viz_grid.size();
+    point_offset += node_grid.size();
+  }
+  for (int i = 0; i < piece.ncells; ++i) {
+    offsets.h_view(i, 0) = (i + 1) * ncorners;
+    types.h_view(i, 0) = vtk_types[dim];
+  }
+  add_vtu_array(piece, "Cells", "connectivity", connectivity, false);
+  add_vtu_array(piece, "Cells", "offsets", offsets, false);
+  add_vtu_array(piece, "Cells", "types", types, false);
+}
+
+void add_vtu_blocks(
+    VtuPiece& piece,
+    int dim,
+    std::vector<Block const*> const& blocks,
+    bool averages) {
+  CALI_CXX_MARK_FUNCTION;
+  int const ncorners = ipow(2, dim);
+  piece.ncells = 0;
+  piece.npoints = 0;
+  for (Block const* block : blocks) {
+    p3a::grid3 const g = block->cell_grid();
+    p3a::grid3 const viz_grid = generalize(get_viz_cell_grid(g, get_viz_p(*block, averages)));
+    piece.ncells += viz_grid.size();
+    piece.npoints += get_viz_node_grid(viz_grid, dim).size();
+  }
+  add_vtu_points(piece, blocks, dim, averages);
+  add_vtu_cells(piece, blocks, dim, ncorners, averages);
+}
+
+template <class T>
+void add_vtu_field(
+    VtuPiece& piece,
+    std::string const& name,
+    std::vector<VizView<T>> const& fields) {
+  CALI_CXX_MARK_FUNCTION;
+  int const ncomps = fields.empty() ? 1 : fields[0].h_view.extent(1);
+  VizView<T> all;
+  Kokkos::resize(all, piece.ncells, ncomps);
+  int offset = 0;
+  for (VizView<T> f : fields) {
+    f.template sync<typename VizView<T>::host_mirror_space>();
+    int const n = f.h_view.extent(0);
+    for (int i = 0; i < n; ++i) {
+      for (int c = 0; c < ncomps; ++c) {
+        all.h_view(offset + i, c) = f.h_view(i, c);
+      }
+    }
+    offset += n;
+  }
+  if (offset != piece.ncells) {
+    throw std::runtime_error("vtk - field does not match piece cells");
+  }
+  add_vtu_array(piece, "CellData", name, all, false);
+}
+
+template void add_vtu_field<int>(VtuPiece&, std::string const&, std::vector<VizView<int>> const&);
+template void add_vtu_field<float>(VtuPiece&, std::string const&, std::vector<VizView<float>> const&);
+template void add_vtu_field<double>(VtuPiece&, std::string const&, std::vector<VizView<double>> const&);
+
+static void write_vtu_section(
+    std::stringstream& stream,
+    VtuPiece const& piece,
+    std::string const& section,
+    std::uint64_t base) {
+  stream << "<" << section << ">\n";
+  for (VtuArray const& array : piece.arrays) {
+    if (array.section != section) continue;
+    stream << "<DataArray type=\"" << array.type << "\" ";
+    stream << "Name=\"" << array.name << "\" ";
+    stream << "NumberOfComponents=\"" << array.ncomps << "\" ";
+    stream << "format=\"appended\" ";
+    stream << "offset=\"" << base + array.offset << "\"/>\n";
+  }
+  stream << "</" << section << ">\n";
+}
+
+static void write_vtu_piece(
+    std::stringstream& stream,
+    VtuPiece const& piece,
+    std::uint64_t base) {
+  stream << "<Piece NumberOfPoints=\"" << piece.npoints << "\" ";
+  stream << "NumberOfCells=\"" << piece.ncells << "\">\n";
+  write_vtu_section(stream, piece, "Points", base);
+  write_vtu_section(stream, piece, "Cells", base);
+  write_vtu_section(stream, piece, "CellData", base);
+  stream << "</Piece>\n";
+}
+
+static constexpr std::uint64_t max_chunk = std::numeric_limits<int>::max();
+
+static int get_chunk_count(std::uint64_t size, std::uint64_t start) {
+  return int(std::min(size - start, max_chunk));
+}
+
+static std::string gather_string(MPI_Comm comm, std::string const& local) {
+  int rank, size;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &size);
+  std::uint64_t const count = local.size();
+  std::vector<std::uint64_t> counts(size, 0);
+  MPI_Gather(&count, 1, MPI_UINT64_T, counts.data(), 1, MPI_UINT64_T, 0, comm);
+  if (rank != 0) {
+    for (std::uint64_t start = 0; start < count; start += max_chunk) {
+      MPI_Send(local.data() + start, get_chunk_count(count, start),
+          MPI_CHAR, 0, 0, comm);
+    }
+    return std::string();
+  }
+  std::uint64_t total = 0;
+  for (int i = 0; i < size; ++i) {
+    total += counts[i];
+  }
+  std::string result(total, '\0');
+  std::copy(local.begin(), local.end(), result.begin());
+  std::uint64_t offset = count;
+  for (int i = 1; i < size; ++i) {
+    for (std::uint64_t start = 0; start < counts[i]; start += max_chunk) {
+      MPI_Recv(result.data() + offset + start, get_chunk_count(counts[i], start),
+          MPI_CHAR, i, 0, comm, MPI_STATUS_IGNORE);
+    }
+    offset += counts[i];
+  }
+  return result;
+}
+
+static void verify_nwriters(int nwriters, int nranks) {
+  if ((nwriters < 1) || (nwriters > nranks)) {
+    throw std::runtime_error("vtk - invalid number of writers");
+  }
+}
+
+int get_vtu_group(int rank, int nranks, int nwriters) {
+  verify_nwriters(nwriters, nranks);
+  return int((std::int64_t(rank) * nwriters) / nranks);
+}
+
+void gather_vtu(
+    mpicpp::comm* comm,
+    int nwriters,
+    VtuPiece const& piece,
+    VtuFile& file) {
+  CALI_CXX_MARK_FUNCTION;
+  int const rank = comm->rank();
+  int const nranks = comm->size();
+  int const group = get_vtu_group(rank, nranks, nwriters);
+  MPI_Comm group_comm;
+  MPI_Comm_split(comm->get(), group, rank, &group_comm);
+  int group_rank;
+  MPI_Comm_rank(group_comm, &group_rank);
+  std::uint64_t const nbytes = piece.data.nbytes;
+  std::uint64_t base = 0;
+  MPI_Exscan(&nbytes, &base, 1, MPI_UINT64_T, MPI_SUM, group_comm);
+  if (group_rank == 0) base = 0;
+  std::stringstream stream;
+  write_vtu_piece(stream, piece, base);
+  std::string data;
+  data.reserve(nbytes);
+  for (std::string const& array : piece.data.arrays) {
+    data += array;
+  }
+  file.group = group;
+  file.ngroups = nwriters;
+  file.writer = (group_rank == 0);
+  file.compression = piece.data.compression;
+  file.pieces = gather_string(group_comm, stream.str());
+  file.data = gather_string(group_comm, data);
+  MPI_Comm_free(&group_comm);
+}
+
+void write_vtu(
+    std::filesystem::path const& prefix,
+    VtuFile const& file,
+    double time,
+    int step) {
+  CALI_CXX_MARK_FUNCTION;
+  if (!file.writer) return;
+  std::stringstream stream;
+  std::filesystem::path const path(prefix.string() + std::to_string(file.group) + ".vtu");
+  write_vtu_header(stream, file.compression);
+  stream << "<UnstructuredGrid>\n";
+  stream << std::scientific << std::setprecision(12);
+  stream << "<FieldData>\n";
+  write_vtr_time(stream, time);
+  write_vtr_step(stream, step);
+  stream << "</FieldData>\n";
+  stream << file.pieces;
+  stream << "</UnstructuredGrid>\n";
+  std::ofstream out(path.c_str(), std::ios::binary);
+  if (!out.is_open()) {
+    throw std::runtime_error("vtk - could not open: " + path.string());
+  }
+  out << stream.rdbuf();
+  out << "<AppendedData encoding=\"raw\">\n_";
+  out.write(file.data.data(), std::streamsize(file.data.size()));
+  out << "\n</AppendedData>\n";
+  out << "</VTKFile>\n";
+  out.close();
+}
+
+
 }
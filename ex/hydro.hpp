@@ -1,20 +1,28 @@
 #pragma once
 
 #include <filesystem>
-#include <functional>
 
 #include "p3a_reduce.hpp"
 #include "p3a_static_vector.hpp"
 #include "p3a_dynamic_array.hpp"
 
+#include "dgt_error.hpp"
 #include "dgt_library.hpp"
 #include "dgt_mesh.hpp"
+#include "dgt_output.hpp"
+#include "dgt_reduce.hpp"
+#include "dgt_rk.hpp"
 #include "dgt_spatial.hpp"
+#include "dgt_trace.hpp"
 
 namespace hydro {
 
 enum {RH=0,MM=1,MX=1,MY=2,MZ=3,EN=4,NEQ=5};
 enum {VE=1,VX=1,VY=2,VZ=3,PR=4};
+enum {INVALID_PRESSURE=1,INVALID_WAVE_SPEED=2};
+enum {NO_EXACT,ADVECT_EXACT,ISENTROPIC_VORTEX_EXACT};
+enum {L1=0,L2=1,NERR=2};
+enum {TIME_STEP_KERNEL,INTR_FACE_KERNEL,BORDER_FLUX_KERNEL,AMR_BORDER_FLUX_KERNEL,VOL_INTEGRAL_KERNEL};
 
 struct State;
 
@@ -34,13 +42,13 @@ using dgt::Block;
 using dgt::Node;
 using dgt::Mesh;
 
-using Exact = std::function<void(State&, Block&, View<double***>)>;
-
 struct Input {
   std::string name;
   mpicpp::comm* comm;
   int p = -1;
   bool tensor = true;
+  std::string rk = "";
+  bool trace_cache = false;
   p3a::vector3<double> xmin;
   p3a::vector3<double> xmax;
   p3a::vector3<int> block_grid;
@@ -58,8 +66,13 @@ struct Input {
   int gravity_axis = Y;
   int step_frequency = -1;
   double out_frequency = -1.;
+  int out_compression = 1;
+  int out_compression_threads = 1;
+  int out_writers = 0;
+  bool out_float = false;
+  bool out_averages = false;
   double amr_frequency = -1.;
-  Exact exact_solution = nullptr;
+  int exact_solution = NO_EXACT;
   double error_regression = 0.;
 };
 
@@ -69,10 +82,11 @@ struct State {
   double dt;
   double t;
   int step;
-  int ssp_rk_stages;
-  p3a::device_array<std::int8_t> error_code;
+  dgt::RKScheme rk;
+  dgt::ErrorFlag error;
   std::vector<double> out_times;
-  View<double***> scratch;
+  View<double***> avg;
+  dgt::OutputQueue output;
 };
 
 template <class T>
@@ -185,6 +199,65 @@ p3a::static_vector<T, NEQ> get_hllc_flux(
   return F_hllc;
 }
 
+[[nodiscard]] P3A_HOST_DEVICE inline
+p3a::static_vector<double, NEQ> get_advect_state(
+    p3a::vector3<double> const& x,
+    int dim) {
+  p3a::vector3<double> v(0,0,0);
+  if (dim > 0) v.x() = 1.;
+  if (dim > 1) v.y() = 1.;
+  if (dim > 2) v.z() = 1.;
+  v /= std::sqrt(double(dim));
+  double const pi = p3a::pi_value<double>();
+  double const ksi = x.x() + x.y() + x.z();
+  double const rho = 1. + 0.25 * std::sin(2. * pi * ksi);
+  double const rho_eint = 0.8;
+  p3a::static_vector<double, NEQ> U;
+  U[RH] = rho;
+  U[MX] = rho * v.x();
+  U[MY] = rho * v.y();
+  U[MZ] = rho * v.z();
+  U[EN] = rho_eint + 0.5 * rho * dot_product(v,v);
+  return U;
+}
+
+[[nodiscard]] P3A_HOST_DEVICE inline
+p3a::static_vector<double, NEQ> get_isentropic_vortex_state(
+    p3a::vector3<double> const& x,
+    double gamma) {
+  p3a::vector3<double> const c(5,5,0);
+  p3a::vector3<double> const v0(1,1,0);
+  double const beta = 5.;
+  double const pi = p3a::pi_value<double>();
+  double const r = magnitude(x - c);
+  double const base =
+    (1. - (gamma-1.)*beta*beta / (8.*gamma*pi*pi) * std::exp(1.-r*r));
+  double const rho = std::pow(base, 1./(gamma-1.));
+  double const P = std::pow(rho, gamma);
+  p3a::vector3<double> v(0.,0.,0.);
+  v.x() = -(x.y() - c.y()) * (0.5*beta/pi) * std::exp(0.5*(1.-r*r));
+  v.y() =  (x.x() - c.x()) * (0.5*beta/pi) * std::exp(0.5*(1.-r*r));
+  v += v0;
+  double const half_v2 = 0.5*dot_product(v,v);
+  p3a::static_vector<double, NEQ> U;
+  U[RH] = rho;
+  U[MX] = rho * v.x();
+  U[MY] = rho * v.y();
+  U[MZ] = rho * v.z();
+  U[EN] = P/(gamma-1.) + rho*half_v2; // ideal gas
+  return U;
+}
+
+[[nodiscard]] P3A_HOST_DEVICE inline
+p3a::static_vector<double, NEQ> get_exact_state(
+    int exact,
+    p3a::vector3<double> const& x,
+    int dim,
+    double gamma) {
+  if (exact == ADVECT_EXACT) return get_advect_state(x, dim);
+  return get_isentropic_vortex_state(x, gamma);
+}
+
 void parse_input(Input& in, mpicpp::comm* comm, std::string const& name);
 void print_input(Input const& in);
 void verify_input(Input const& in);
@@ -195,25 +268,23 @@ void do_amr(State& state);
 void set_ics(State& state);
 void set_exact(State& state);
 
-double compute_stable_time_step(State& state, Block const& block);
-void compute_intr_fluxes(State& state, Block& block, int axis, int soln_idx);
+dgt::ReduceValues compute_step_values(State& state, bool dt, bool tallies, bool errors);
+void compute_intr_face_integral(State& state, int axis, int soln_idx, bool store_flux);
 void compute_border_fluxes(State& state, Block& block, int axis, int dir);
 void compute_amr_border_fluxes(State& state, Block& block, int axis, int dir);
-void compute_vol_integral(State& state, Block& block, int soln_idx);
-void compute_side_integral(Block& block, int axis);
+void zero_residual(State& state);
+void compute_vol_integral(State& state, int soln_idx);
+void compute_border_side_integral(State& state, int axis);
+void check_errors(State& state);
 void compute_amr_side_integral(Block& block, int axis, int dir);
-void compute_gravity_source(Block& block, int soln_idx, double g, int axis);
-void advance_explicitly(Block& block, int from_idx, int to_idx, double dt);
-void limit(State& state, Block& block, int soln_idx, View<double***> scratch);
+void compute_gravity_source(State& state, int soln_idx, double g, int axis);
+void advance_explicitly(State& state, int from_idx, int to_idx, double dt);
 void preserve_bounds(State& state, Block& block, int soln_idx);
 void preserve_bounds_amr(State& state, Block& block, int axis, int dir, int soln_idx);
+void finalize_stage(State& state, int soln_idx, dgt::RKStage const& stage);
 void reflect_boundary(Border& border);
 
-double compute_tally(Block& block, int eq);
-double compute_L1_error(Block& block, View<double***> U_ex, int eq);
-double compute_L2_error(Block& block, View<double***> U_ex, int eq);
-
-void write_mesh(std::filesystem::path const& path, State const& state, int soln_idx);
+void write_mesh(std::filesystem::path const& path, State& state, int soln_idx);
 void write_out(State& state, int soln_idx = 0);
 void write_pvd(State& state);
 
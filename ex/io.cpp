@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <fstream>
+#include <memory>
 #include <stdexcept>
 
 #include "caliper/cali.h"
@@ -75,6 +77,8 @@ void parse_input(
     val = trim(val);
     if      (key == "p") in.p = dgt::string_to_type<int>(val);
     else if (key == "tensor") in.tensor = dgt::string_to_type<bool>(val);
+    else if (key == "rk") in.rk = val;
+    else if (key == "trace_cache") in.trace_cache = dgt::string_to_type<bool>(val);
     else if (key == "xmin") in.xmin = parse_vec3<double>(val);
     else if (key == "xmax") in.xmax = parse_vec3<double>(val);
     else if (key == "block_grid") in.block_grid = parse_vec3<int>(val);
@@ -92,12 +96,18 @@ void parse_input(
     else if (key == "gravity_axis") in.gravity_axis = dgt::string_to_type<int>(val);
     else if (key == "step_frequency") in.step_frequency = dgt::string_to_type<int>(val);
     else if (key == "out_frequency") in.out_frequency = dgt::string_to_type<double>(val);
+    else if (key == "out_compression") in.out_compression = dgt::string_to_type<int>(val);
+    else if (key == "out_compression_threads") in.out_compression_threads = dgt::string_to_type<int>(val);
+    else if (key == "out_writers") in.out_writers = dgt::string_to_type<int>(val);
+    else if (key == "out_float") in.out_float = dgt::string_to_type<bool>(val);
+    else if (key == "out_averages") in.out_averages = dgt::string_to_type<bool>(val);
     else if (key == "amr_frequency") in.amr_frequency = dgt::string_to_type<double>(val);
     else if (key == "error_regression") in.error_regression = dgt::string_to_type<double>(val);
     else {
       throw std::runtime_error("invalid input key: " + key);
     }
   }
+  if (in.rk == "") in.rk = dgt::get_default_rk_scheme(in.p);
 }
 
 void print_input(Input const& in) {
@@ -109,6 +119,8 @@ void print_input(Input const& in) {
   std::cout << " > num mpi ranks: " << in.comm->size() << "\n";
   std::cout << " > polynomial order: " << in.p << "\n";
   std::cout << " > tensor product basis: " << in.tensor << "\n";
+  std::cout << " > time integrator: " << in.rk << "\n";
+  std::cout << " > trace cache: " << in.trace_cache << "\n";
   std::cout << " > xmin: " << in.xmin << "\n";
   std::cout << " > xmax: " << in.xmax << "\n";
   std::cout << " > block grid: " << in.block_grid << "\n";
@@ -125,39 +137,44 @@ void print_input(Input const& in) {
   std::cout << " > gravity axis: " << in.gravity_axis << "\n";
   std::cout << " > step frequency: " << in.step_frequency << "\n";
   std::cout << " > out frequency: " << in.out_frequency << "\n";
+  std::cout << " > out compression: " << in.out_compression << "\n";
+  std::cout << " > out compression threads: " << in.out_compression_threads << "\n";
+  std::cout << " > out writers: " << in.out_writers << "\n";
+  std::cout << " > out float: " << in.out_float << "\n";
+  std::cout << " > out averages: " << in.out_averages << "\n";
   std::cout << " > amr frequency: " << in.amr_frequency << "\n";
   std::cout << " > error regression: " << in.error_regression << "\n";
 }
 
 void verify_input(Input const& in) {
   if ((in.p < 0) || (in.p > dgt::max_p)) throw std::runtime_error("input - invalid p");
+  if (in.trace_cache && !in.tensor) throw std::runtime_error("input - trace cache requires a tensor basis");
   if (in.gamma < 0) throw std::runtime_error("input - invalid gamma");
   if (in.tfinal <= 0) throw std::runtime_error("input - invalid final time");
   if ((in.CFL <= 0) || (in.CFL >= 1)) throw std::runtime_error("input - invalid CFL");
   if (in.step_frequency <= 0) throw std::runtime_error("input - invalid step frequency");
   if (in.out_frequency <= 0) throw std::runtime_error("input - invalid out frequency");
+  if (in.out_compression > 9) throw std::runtime_error("input - invalid out compression");
+  if (in.out_compression_threads < 1) throw std::runtime_error("input - invalid out compression threads");
+  if (in.out_writers > in.comm->size()) throw std::runtime_error("input - invalid out writers");
 }
 
 template <class T>
 P3A_HOST_DEVICE void assign_variable(
-    dgt::vtk::VizView<double> v, int idx, T const& val);
-
-template <>
-P3A_HOST_DEVICE void assign_variable(
-    dgt::vtk::VizView<double> v, int idx, double const& val) {
-  v.d_view(idx, 0) = val;
+    dgt::vtk::VizView<T> v, int idx, double const& val) {
+  v.d_view(idx, 0) = T(val);
 }
 
-template <>
+template <class T>
 P3A_HOST_DEVICE void assign_variable(
-    dgt::vtk::VizView<double> v, int idx, p3a::vector3<double> const& val) {
-  v.d_view(idx, X) = val.x();
-  v.d_view(idx, Y) = val.y();
-  v.d_view(idx, Z) = val.z();
+    dgt::vtk::VizView<T> v, int idx, p3a::vector3<double> const& val) {
+  v.d_view(idx, X) = T(val.x());
+  v.d_view(idx, Y) = T(val.y());
+  v.d_view(idx, Z) = T(val.z());
 }
 
-template <class Function>
-dgt::vtk::VizView<double> get_variable(
+template <class T, class Function>
+dgt::vtk::VizView<T> get_variable(
     Function const& function,
     Block const& block,
     int num_comps,
@@ -169,7 +186,7 @@ dgt::vtk::VizView<double> get_variable(
   p3a::grid3 const inner_grid = dgt::tensor_bounds(b.dim, b.p);
   p3a::grid3 const viz_cell_grid = dgt::generalize(dgt::get_viz_cell_grid(g, b.p));
   View<double***> U = block.soln(soln_idx);
-  dgt::vtk::VizView<double> var;
+  dgt::vtk::VizView<T> var;
   Kokkos::resize(var, viz_cell_grid.size(), num_comps);
   auto f = [=] P3A_HOST_DEVICE (p3a::vector3<int> const& cell_ijk) {
     int const cell = cell_grid.index(cell_ijk);
@@ -187,11 +204,38 @@ dgt::vtk::VizView<double> get_variable(
   return var;
 }
 
+template <class T, class Function>
+dgt::vtk::VizView<T> get_average(
+    Function const& function,
+    Block const& block,
+    int num_comps,
+    int soln_idx,
+    double gamma = 0.) {
+  p3a::grid3 const cell_grid = dgt::generalize(block.cell_grid());
+  View<double***> U = block.soln(soln_idx);
+  dgt::vtk::VizView<T> var;
+  Kokkos::resize(var, cell_grid.size(), num_comps);
+  auto f = [=] P3A_HOST_DEVICE (p3a::vector3<int> const& cell_ijk) {
+    int const cell = cell_grid.index(cell_ijk);
+    p3a::static_vector<double, NEQ> U_avg;
+    for (int eq = 0; eq < NEQ; ++eq) {
+      U_avg[eq] = U(cell, eq, 0);
+    }
+    assign_variable(var, cell, function(U_avg, gamma));
+  };
+  p3a::for_each(p3a::execution::par, cell_grid, f);
+  return var;
+}
+
 struct density {
   P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline double operator()(
       View<double***> U, dgt::Basis const& b, int cell, int pt, double) const {
     return interp_scalar_intr(U, b, cell, pt, RH);
   }
+  P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline double operator()(
+      p3a::static_vector<double, NEQ> const& U, double) const {
+    return U[RH];
+  }
 };
 
 struct velocity {
@@ -201,6 +245,10 @@ struct velocity {
     p3a::vector3<double> const m = interp_vec3_intr(U, b, cell, pt, MM);
     return m/rho;
   }
+  P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline p3a::vector3<double> operator()(
+      p3a::static_vector<double, NEQ> const& U, double) const {
+    return get_vec3(U, MM)/U[RH];
+  }
 };
 
 struct pressure {
@@ -210,39 +258,90 @@ struct pressure {
     double const val = get_pressure(U_pt, gamma);
     return val;
   }
+  P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline double operator()(
+      p3a::static_vector<double, NEQ> const& U, double gamma) const {
+    return get_pressure(U, gamma);
+  }
 };
 
+template <class T, class Function>
+dgt::vtk::VizView<T> get_output(
+    Input const& in,
+    Function const& function,
+    Block const& block,
+    int num_comps,
+    int soln_idx) {
+  if (in.out_averages) {
+    return get_average<T>(function, block, num_comps, soln_idx, in.gamma);
+  }
+  return get_variable<T>(function, block, num_comps, soln_idx, in.gamma);
+}
+
+template <class T>
+static void snapshot(dgt::vtk::VizView<T> var) {
+  var.modify_device();
+  var.sync_host();
+}
+
+template <class T>
+static void add_fields(
+    State const& state,
+    std::vector<Block const*> const& blocks,
+    int soln_idx,
+    dgt::vtk::VtuPiece& piece) {
+  Input const& in = state.in;
+  density f_rho;
+  velocity f_vel;
+  pressure f_press;
+  std::vector<dgt::vtk::VizView<T>> rho, vel, press;
+  for (Block const* block : blocks) {
+    rho.push_back(get_output<T>(in, f_rho, *block, 1, soln_idx));
+    vel.push_back(get_output<T>(in, f_vel, *block, DIMS, soln_idx));
+    press.push_back(get_output<T>(in, f_press, *block, 1, soln_idx));
+    snapshot(rho.back());
+    snapshot(vel.back());
+    snapshot(press.back());
+  }
+  dgt::vtk::add_vtu_field(piece, "density", rho);
+  dgt::vtk::add_vtu_field(piece, "velocity", vel);
+  dgt::vtk::add_vtu_field(piece, "pressure", press);
+}
+
 void write_mesh(
     std::filesystem::path const& path,
-    State const& state,
+    State& state,
     int soln_idx) {
   CALI_CXX_MARK_FUNCTION;
   Input const& in = state.in;
   Mesh const& mesh = state.mesh;
   std::filesystem::create_directory(path);
-  density f_rho;
-  velocity f_vel;
-  pressure f_press;
-  double const gamma = in.gamma;
+  std::vector<Block const*> blocks;
   for (Node* leaf : mesh.owned_leaves()) {
-    std::stringstream stream;
-    Block const& block = leaf->block;
-    std::filesystem::path block_path = path;
-    block_path /= std::to_string(block.id()) + ".vtr";
-    dgt::vtk::write_vtr_start(stream, block, state.t, state.step);
-    dgt::vtk::write_field(stream, "density", get_variable(f_rho, block, 1, soln_idx));
-    dgt::vtk::write_field(stream, "velocity", get_variable(f_vel, block, DIMS, soln_idx));
-    dgt::vtk::write_field(stream, "pressure", get_variable(f_press, block, 1, soln_idx, gamma));
-    dgt::vtk::write_vtr_end(stream);
-    dgt::write_stream(block_path, stream);
+    blocks.push_back(&leaf->block);
   }
+  dgt::vtk::VtuPiece piece;
+  piece.data.compression.enabled = (in.out_compression >= 0);
+  piece.data.compression.level = std::max(in.out_compression, 0);
+  piece.data.compression.nthreads = in.out_compression_threads;
+  dgt::vtk::add_vtu_blocks(piece, mesh.dim(), blocks, in.out_averages);
+  if (in.out_float) add_fields<float>(state, blocks, soln_idx, piece);
+  else add_fields<double>(state, blocks, soln_idx, piece);
+  int const nwriters = (in.out_writers > 0) ? in.out_writers : mesh.comm()->size();
+  auto file = std::make_shared<dgt::vtk::VtuFile>();
+  dgt::vtk::gather_vtu(mesh.comm(), nwriters, piece, *file);
   if (state.mesh.comm()->rank() == 0) {
     std::filesystem::path vtm_path = path;
     vtm_path /= "blocks.vtm";
     std::stringstream stream;
-    dgt::vtk::write_vtm(stream, "", mesh.leaves().size());
+    dgt::vtk::write_vtm(stream, "", file->ngroups, ".vtu");
     dgt::write_stream(vtm_path, stream);
   }
+  double const t = state.t;
+  int const step = state.step;
+  auto job = [=] () {
+    dgt::vtk::write_vtu(path / "", *file, t, step);
+  };
+  state.output.push(job);
 }
 
 void write_out(State& state, int soln_idx) {
@@ -3,10 +3,12 @@
 #include "caliper/cali.h"
 
 #include "dgt_amr.hpp"
+#include "dgt_dispatch.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_interp.hpp"
 #include "dgt_interp_simd.hpp"
 #include "dgt_spatial.hpp"
+#include "dgt_tensor.hpp"
 #include "dgt_views.hpp"
 
 #include "hydro.hpp"
@@ -142,9 +144,10 @@ struct BorderData {
   public:
     p3a::static_array<p3a::static_array<int, ndirs>, DIMS> border_type;
     p3a::static_array<p3a::static_array<p3a::grid3, ndirs>, DIMS> bside_grid;
-    p3a::static_array<p3a::static_array<View<double**>, ndirs>, DIMS> avg_U;
-    p3a::static_array<p3a::static_array<View<double***>, ndirs>, DIMS> amr_avg_U;
+    p3a::static_array<p3a::static_array<double*, ndirs>, DIMS> avg_U;
+    p3a::static_array<p3a::static_array<double*, ndirs>, DIMS> amr_avg_U;
   public:
+    BorderData() = default;
     BorderData(Block& block) {
       int const dim = block.dim();
       p3a::grid3 const g = block.cell_grid();
@@ -154,10 +157,12 @@ struct BorderData {
           border_type[axis][dir] = border.type();
           p3a::subgrid3 const adj_sides = dgt::get_adj_sides(g, axis, dir);
           bside_grid[axis][dir] = dgt::generalize(adj_sides.extents());
+          avg_U[axis][dir] = nullptr;
+          amr_avg_U[axis][dir] = nullptr;
           if (border_type[axis][dir] == dgt::COARSE_TO_FINE) {
-            amr_avg_U[axis][dir] = border.amr(recv).avg_soln;
+            amr_avg_U[axis][dir] = border.amr(recv).avg_soln.data();
           } else {
-            avg_U[axis][dir] = border.avg_soln(recv).val;
+            avg_U[axis][dir] = border.avg_soln(recv).val.data();
           }
         }
       }
@@ -177,9 +182,18 @@ bool needs_border(
   return false;
 }
 
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<double, NEQ> gather_cell_avg(View<double**> soln_avg, int cell) {
+  p3a::static_vector<double, NEQ> U_avg;
+  for (int eq = 0; eq < NEQ; ++eq) {
+    U_avg[eq] = soln_avg(cell, eq);
+  }
+  return U_avg;
+}
+
 [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
 p3a::static_vector<double, NEQ> get_adj_avg(
-    View<double***> soln,
+    View<double**> soln_avg,
     BorderData const& dat,
     p3a::grid3 const& cell_grid,
     p3a::vector3<int> const& cell_ijk,
@@ -190,71 +204,70 @@ p3a::static_vector<double, NEQ> get_adj_avg(
   if (!needs_border(cell_grid, cell_ijk, axis, dir)) {
     p3a::vector3<int> const adj_cell_ijk = dgt::get_cells_adj_cell(cell_ijk, axis, dir);
     int const adj_cell = cell_grid.index(adj_cell_ijk);
-    c = dgt::gather_avg<NEQ>(soln, adj_cell);
+    c = gather_cell_avg(soln_avg, adj_cell);
   } else {
     p3a::vector3<int> const side_ijk = dgt::get_cells_adj_side(cell_ijk, axis, dir);
     p3a::vector3<int> const bside_ijk = dgt::get_border_ijk(side_ijk, axis);
+    int const nbsides = dat.bside_grid[axis][dir].size();
     int const bside = dat.bside_grid[axis][dir].index(bside_ijk);
     if (dat.border_type[axis][dir] != dgt::COARSE_TO_FINE) {
-      c = gather_border_avg(dat.avg_U[axis][dir], bside);
+      dgt::UnmanagedView<double**> const avg_U(dat.avg_U[axis][dir], nbsides, NEQ);
+      c = gather_border_avg(avg_U, bside);
     } else {
-      c = gather_amr_border_avg(dat.amr_avg_U[axis][dir], nchild, bside);
+      dgt::UnmanagedView<double***> const amr_avg_U(dat.amr_avg_U[axis][dir], nbsides, nchild, NEQ);
+      c = gather_amr_border_avg(amr_avg_U, nchild, bside);
     }
   }
   return c;
 }
 
-void limit(State& state, Block& block, int soln_idx, View<double***> soln_lim) {
-  CALI_CXX_MARK_FUNCTION;
-  if (block.basis().p == 0) return;
-  int const dim = block.dim();
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  p3a::vector3<double> const dx = block.dx();
-  Basis const b = block.basis();
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void limit_cell(
+    View<double**> soln_avg,
+    View<double***> soln,
+    View<double***> soln_lim,
+    BorderData const& dat,
+    p3a::grid3 const& cell_grid,
+    p3a::vector3<int> const& cell_ijk,
+    p3a::vector3<double> const& dx,
+    Basis const& b,
+    double gamma,
+    double M,
+    double beta) {
+  int const dim = b.dim;
   int const nchild = dgt::num_child(dim-1);
-  BorderData dat(block);
-  double const gamma = state.in.gamma;
-  double const M = state.in.M;
-  double const beta = state.in.beta;
-  View<double***> soln = block.soln(soln_idx);
-  Kokkos::deep_copy(soln_lim, soln);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
-    p3a::static_vector<double, NEQ> dc, dp, dc_lim, dp_lim;
-    p3a::static_vector<double, NEQ> c[ndirs+1], p[ndirs+1];
-    bool should_zero = false;
-    int const cell = cell_grid.index(cell_ijk);
-    c[center] = dgt::gather_avg<NEQ>(soln, cell);
-    p[center] = convert_to_primitive(c[center], gamma);
-    for (int axis = 0; axis < dim; ++axis) {
-      int const dg_mode = 1 + axis;
-      dc = gather_dg_slopes(soln, cell, dg_mode);
-      dp = convert_to_dprimitive(c[center], dc, gamma);
-      for (int dir = 0; dir < ndirs; ++dir) {
-        c[dir] = get_adj_avg(soln, dat, cell_grid, cell_ijk, axis, dir, nchild);
-        p[dir] = convert_to_primitive(c[dir], gamma);
-      }
-      for (int eq = 0; eq < NEQ; ++eq) {
-        dp_lim[eq] = minmodB(beta, M, dx[axis], dp[eq], p[center][eq], p[left][eq], p[right][eq]);
-        if (dp_lim[eq] != dp[eq]) {
-          should_zero = true;
-        }
-      }
-      dc_lim = convert_to_dconservative(c[center], dp_lim, gamma);
-      for (int eq = 0; eq < NEQ; ++eq) {
-        soln_lim(cell, eq, dg_mode) = dc_lim[eq];
+  p3a::static_vector<double, NEQ> dc, dp, dc_lim, dp_lim;
+  p3a::static_vector<double, NEQ> c[ndirs+1], p[ndirs+1];
+  bool should_zero = false;
+  int const cell = cell_grid.index(cell_ijk);
+  c[center] = dgt::gather_avg<NEQ>(soln, cell);
+  p[center] = convert_to_primitive(c[center], gamma);
+  for (int axis = 0; axis < dim; ++axis) {
+    int const dg_mode = 1 + axis;
+    dc = gather_dg_slopes(soln, cell, dg_mode);
+    dp = convert_to_dprimitive(c[center], dc, gamma);
+    for (int dir = 0; dir < ndirs; ++dir) {
+      c[dir] = get_adj_avg(soln_avg, dat, cell_grid, cell_ijk, axis, dir, nchild);
+      p[dir] = convert_to_primitive(c[dir], gamma);
+    }
+    for (int eq = 0; eq < NEQ; ++eq) {
+      dp_lim[eq] = minmodB(beta, M, dx[axis], dp[eq], p[center][eq], p[left][eq], p[right][eq]);
+      if (dp_lim[eq] != dp[eq]) {
+        should_zero = true;
       }
     }
-    if (should_zero) {
-      for (int eq = 0; eq < NEQ; ++eq) {
-        for (int m = dim+1; m < b.nmodes; ++m) {
-          soln_lim(cell, eq, m) = 0.;
-        }
+    dc_lim = convert_to_dconservative(c[center], dp_lim, gamma);
+    for (int eq = 0; eq < NEQ; ++eq) {
+      soln_lim(cell, eq, dg_mode) = dc_lim[eq];
+    }
+  }
+  if (should_zero) {
+    for (int eq = 0; eq < NEQ; ++eq) {
+      for (int m = dim+1; m < b.nmodes; ++m) {
+        soln_lim(cell, eq, m) = 0.;
       }
     }
-  };
-  p3a::for_each(p3a::execution::par, cell_grid, f);
-  Kokkos::deep_copy(soln, soln_lim);
+  }
 }
 
 [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
@@ -268,6 +281,28 @@ double get_min_eval(View<double***> U, Basis const& b, int cell, int eq) {
   return min_val;
 }
 
+template <class O>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+double get_min_eval(View<double***> U, Basis const& b, int cell, int eq) {
+  if constexpr (O::tensor) {
+    double vals[O::nintr_pts];
+    dgt::tensor_interp_intr<O>(U, b, cell, eq, vals);
+    double min_val = vals[0];
+    for (int pt = 1; pt < O::nintr_pts; ++pt) {
+      min_val = p3a::min(min_val, vals[pt]);
+    }
+    for (int axis = 0; axis < O::dim; ++axis) {
+      for (int dir = 0; dir < ndirs; ++dir) {
+        double const side_min = dgt::tensor_min_side<O>(U, b, cell, axis, dir, eq);
+        min_val = p3a::min(min_val, side_min);
+      }
+    }
+    return min_val;
+  } else {
+    return get_min_eval(U, b, cell, eq);
+  }
+}
+
 [[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
 double get_min_amr(
     View<double***> U,
@@ -297,76 +332,139 @@ double bound_theta(double theta) {
   return btheta;
 }
 
-void preserve_bounds(State& state, Block& block, int soln_idx) {
-  CALI_CXX_MARK_FUNCTION;
-  if (block.basis().p == 0) return;
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  Basis const b = block.basis();
+template <class O>
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void preserve_bounds_cell(View<double***> U, Basis const& b, int cell, double gamma) {
   int const neval_pts = dgt::num_eval_pts(b.dim, b.p);
-  View<double***> U = block.soln(soln_idx);
-  double const gamma = state.in.gamma;
   double const rho_floor = rho_floor_val;
   double const P_floor = P_floor_val;
   double const E_floor = P_floor/(gamma-1.); // ideal gas
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
-    int const cell = cell_grid.index(cell_ijk);
-    p3a::static_vector<double, NEQ> U_pt;
-    { // small densities
-      if (U(cell, RH, 0) < rho_floor) {
-        U(cell, RH, 0) = rho_floor;
-        U(cell, MX, 0) = 0.;
-        U(cell, MY, 0) = 0.;
-        U(cell, MZ, 0) = 0.;
-        U(cell, EN, 0) = E_floor;
-        for (int eq = 0; eq < NEQ; ++eq) {
-          for (int m = 1; m < b.nmodes; ++m) {
-            U(cell, eq, m) = 0.;
-          }
+  p3a::static_vector<double, NEQ> U_pt;
+  { // small densities
+    if (U(cell, RH, 0) < rho_floor) {
+      U(cell, RH, 0) = rho_floor;
+      U(cell, MX, 0) = 0.;
+      U(cell, MY, 0) = 0.;
+      U(cell, MZ, 0) = 0.;
+      U(cell, EN, 0) = E_floor;
+      for (int eq = 0; eq < NEQ; ++eq) {
+        for (int m = 1; m < b.nmodes; ++m) {
+          U(cell, eq, m) = 0.;
         }
-      } else {
-        double const rho_avg = U(cell, RH, 0);
-        double const rho_min = get_min_eval(U, b, cell, RH);
-        if (rho_min < rho_floor) {
-          double const theta = (rho_avg - rho_floor) / (rho_avg - rho_min);
-          double const bounded_theta = bound_theta(theta);
-          for (int m = 1; m < b.nmodes; ++m) {
-            U(cell, RH, m) *= bounded_theta;
-          }
+      }
+    } else {
+      double const rho_avg = U(cell, RH, 0);
+      double const rho_min = get_min_eval<O>(U, b, cell, RH);
+      if (rho_min < rho_floor) {
+        double const theta = (rho_avg - rho_floor) / (rho_avg - rho_min);
+        double const bounded_theta = bound_theta(theta);
+        for (int m = 1; m < b.nmodes; ++m) {
+          U(cell, RH, m) *= bounded_theta;
         }
       }
     }
-    { // small pressures
-      p3a::static_vector<double, NEQ> const U_avg = dgt::gather_avg<NEQ>(U, cell);
-      double const P_avg = get_pressure(U_avg, gamma);
-      if (P_avg < P_floor) {
+  }
+  { // small pressures
+    p3a::static_vector<double, NEQ> const U_avg = dgt::gather_avg<NEQ>(U, cell);
+    double const P_avg = get_pressure(U_avg, gamma);
+    if (P_avg < P_floor) {
+      for (int eq = 0; eq < NEQ; ++eq) {
+        for (int m = 1; m < b.nmodes; ++m) {
+          U(cell, eq, m) = 0.;
+        }
+      }
+    } else {
+      double theta_min = 1.;
+      for (int pt = 0; pt < neval_pts; ++pt) {
+        U_pt = dgt::interp_vec_eval<NEQ>(U, b, cell, pt);
+        double const P_pt = get_pressure(U_pt, gamma);
+        if (P_pt < P_floor) {
+          double const theta = (P_avg-P_floor)/(P_avg-P_pt);
+          theta_min = p3a::min(theta_min, theta);
+        }
+        double const bounded_theta_min = bound_theta(theta_min);
         for (int eq = 0; eq < NEQ; ++eq) {
           for (int m = 1; m < b.nmodes; ++m) {
-            U(cell, eq, m) = 0.;
-          }
-        }
-      } else {
-        double theta_min = 1.;
-        for (int pt = 0; pt < neval_pts; ++pt) {
-          U_pt = dgt::interp_vec_eval<NEQ>(U, b, cell, pt);
-          double const P_pt = get_pressure(U_pt, gamma);
-          if (P_pt < P_floor) {
-            double const theta = (P_avg-P_floor)/(P_avg-P_pt);
-            theta_min = p3a::min(theta_min, theta);
-          }
-          double const bounded_theta_min = bound_theta(theta_min);
-          for (int eq = 0; eq < NEQ; ++eq) {
-            for (int m = 1; m < b.nmodes; ++m) {
-              U(cell, eq, m) *= bounded_theta_min;
-            }
+            U(cell, eq, m) *= bounded_theta_min;
           }
         }
       }
     }
+  }
+}
+
+template <class O>
+static void preserve_bounds(State& state, Block& block, int soln_idx) {
+  p3a::grid3 const g = block.cell_grid();
+  p3a::grid3 const cell_grid = dgt::generalize(g);
+  Basis const b = block.basis();
+  View<double***> U = block.soln(soln_idx);
+  double const gamma = state.in.gamma;
+  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
+    int const cell = cell_grid.index(cell_ijk);
+    preserve_bounds_cell<O>(U, b, cell, gamma);
   };
   p3a::for_each(p3a::execution::par, cell_grid, f);
 }
 
+void preserve_bounds(State& state, Block& block, int soln_idx) {
+  CALI_CXX_MARK_FUNCTION;
+  if (block.basis().p == 0) return;
+  auto f = [&] (auto order) {
+    preserve_bounds<decltype(order)>(state, block, soln_idx);
+  };
+  dgt::dispatch(block.basis(), f);
+}
+
+P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+void preserve_bounds_amr_cell(
+    View<double***> U,
+    Basis const& b,
+    int cell,
+    int axis,
+    int dir,
+    double gamma) {
+  double const rho_floor = rho_floor_val;
+  double const P_floor = P_floor_val;
+  int const nchild_sides = dgt::num_child(b.dim-1);
+  int const nside_pts = dgt::num_pts(b.dim-1, b.p);
+  p3a::static_vector<double, NEQ> U_pt;
+  { // small densities
+    double const rho_avg = U(cell, RH, 0);
+    double const rho_min = get_min_amr(U, b, cell, axis, dir, RH);
+    if (rho_min < rho_floor) {
+      if (rho_avg != rho_min) {
+        double const theta = (rho_avg - rho_floor) / (rho_avg - rho_min);
+        double const bounded_theta = bound_theta(theta);
+        for (int m = 1; m < b.nmodes; ++m) {
+          U(cell, RH, m) *= bounded_theta;
+        }
+      }
+    }
+  }
+  { // small pressures
+    double theta_min = 1.;
+    p3a::static_vector<double, NEQ> const U_avg = dgt::gather_avg<NEQ>(U, cell);
+    double const P_avg = get_pressure(U_avg, gamma);
+    for (int child = 0; child < nchild_sides; ++child) {
+      for (int pt = 0; pt < nside_pts; ++pt) {
+        U_pt = dgt::interp_vec_child_side<NEQ>(U, b, cell, axis, dir, child, pt);
+        double const P_pt = get_pressure(U_pt, gamma);
+        if (P_pt < P_floor) {
+          double const theta = (P_avg-P_floor)/(P_avg-P_pt);
+          theta_min = p3a::min(theta_min, theta);
+        }
+      }
+    }
+    double const bounded_theta_min = bound_theta(theta_min);
+    for (int eq = 0; eq < NEQ; ++eq) {
+      for (int m = 1; m < b.nmodes; ++m) {
+        U(cell, eq, m) *= bounded_theta_min;
+      }
+    }
+  }
+}
+
 void preserve_bounds_amr(
     State& state,
     Block& block,
@@ -381,49 +479,89 @@ void preserve_bounds_amr(
   View<double***> U = block.soln(soln_idx);
   p3a::subgrid3 const border_cells = dgt::generalize(dgt::get_adj_cells(g, axis, dir));
   double const gamma = state.in.gamma;
-  double const rho_floor = rho_floor_val;
-  double const P_floor = P_floor_val;
-  int const nchild_sides = dgt::num_child(b.dim-1);
-  int const nside_pts = dgt::num_pts(b.dim-1, b.p);
   auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
-    p3a::static_vector<double, NEQ> U_pt;
     int const cell = cell_grid.index(cell_ijk);
-    { // small densities
-      double const rho_avg = U(cell, RH, 0);
-      double const rho_min = get_min_amr(U, b, cell, axis, dir, RH);
-      if (rho_min < rho_floor) {
-        if (rho_avg != rho_min) {
-          double const theta = (rho_avg - rho_floor) / (rho_avg - rho_min);
-          double const bounded_theta = bound_theta(theta);
-          for (int m = 1; m < b.nmodes; ++m) {
-            U(cell, RH, m) *= bounded_theta;
-          }
-        }
+    preserve_bounds_amr_cell(U, b, cell, axis, dir, gamma);
+  };
+  p3a::for_each(p3a::execution::par, border_cells, f);
+}
+
+static View<BorderData*> pack_border_data(Mesh& mesh) {
+  std::vector<Node*> const& leaves = mesh.owned_leaves();
+  int const nblocks = leaves.size();
+  View<BorderData*> borders("hydro::borders", nblocks);
+  auto borders_host = Kokkos::create_mirror_view(borders);
+  for (int i = 0; i < nblocks; ++i) {
+    borders_host(i) = BorderData(leaves[i]->block);
+  }
+  Kokkos::deep_copy(borders, borders_host);
+  return borders;
+}
+
+template <class O>
+static void finalize_stage(
+    State& state,
+    int soln_idx,
+    dgt::RKStage const& stage) {
+  dgt::BlockPack const pack = state.mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  Basis const b = state.mesh.basis();
+  double const gamma = state.in.gamma;
+  double const M = state.in.M;
+  double const beta = state.in.beta;
+  int const nregisters = pack.nsoln();
+  Kokkos::resize(state.avg, cell_grid.size(), NEQ, pack.nblocks());
+  View<double***> const avg = state.avg;
+  View<BorderData*> borders;
+  dgt::RKStage const s = stage;
+  if (O::p > 0) {
+    borders = pack_border_data(state.mesh);
+    auto copy_avg = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+      View<double***> const U = pack.soln(block, soln_idx);
+      int const cell = cell_grid.index(cell_ijk);
+      for (int eq = 0; eq < NEQ; ++eq) {
+        avg(cell, eq, block) = U(cell, eq, 0);
       }
-    }
-    { // small pressures
-      double theta_min = 1.;
-      p3a::static_vector<double, NEQ> const U_avg = dgt::gather_avg<NEQ>(U, cell);
-      double const P_avg = get_pressure(U_avg, gamma);
-      for (int child = 0; child < nchild_sides; ++child) {
-        for (int pt = 0; pt < nside_pts; ++pt) {
-          U_pt = dgt::interp_vec_child_side<NEQ>(U, b, cell, axis, dir, child, pt);
-          double const P_pt = get_pressure(U_pt, gamma);
-          if (P_pt < P_floor) {
-            double const theta = (P_avg-P_floor)/(P_avg-P_pt);
-            theta_min = p3a::min(theta_min, theta);
-          }
+    };
+    dgt::for_each_block_cell(p3a::execution::par, pack, copy_avg);
+  }
+  auto f = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+    View<double***> const U = pack.soln(block, soln_idx);
+    int const cell = cell_grid.index(cell_ijk);
+    if constexpr (O::p > 0) {
+      BorderData const& dat = borders(block);
+      View<double**> const soln_avg = Kokkos::subview(avg, Kokkos::ALL, Kokkos::ALL, block);
+      p3a::vector3<double> const dx = pack.block(block).dx;
+      limit_cell(soln_avg, U, U, dat, cell_grid, cell_ijk, dx, b, gamma, M, beta);
+      preserve_bounds_cell<O>(U, b, cell, gamma);
+      for (int axis = 0; axis < O::dim; ++axis) {
+        for (int dir = 0; dir < ndirs; ++dir) {
+          if (dat.border_type[axis][dir] != dgt::COARSE_TO_FINE) continue;
+          if (!needs_border(cell_grid, cell_ijk, axis, dir)) continue;
+          preserve_bounds_amr_cell(U, b, cell, axis, dir, gamma);
         }
       }
-      double const bounded_theta_min = bound_theta(theta_min);
-      for (int eq = 0; eq < NEQ; ++eq) {
-        for (int m = 1; m < b.nmodes; ++m) {
-          U(cell, eq, m) *= bounded_theta_min;
-        }
+    }
+    if (s.combine) {
+      p3a::static_array<View<double***>, dgt::max_rk_registers> registers;
+      for (int r = 0; r < nregisters; ++r) {
+        registers[r] = pack.soln(block, r);
       }
+      dgt::combine_registers(s, nregisters, registers, cell, NEQ, O::nmodes);
     }
   };
-  p3a::for_each(p3a::execution::par, border_cells, f);
+  dgt::for_each_block_cell(p3a::execution::par, pack, f);
+}
+
+void finalize_stage(
+    State& state,
+    int soln_idx,
+    dgt::RKStage const& stage) {
+  CALI_CXX_MARK_FUNCTION;
+  auto f = [&] (auto order) {
+    finalize_stage<decltype(order)>(state, soln_idx, stage);
+  };
+  dgt::dispatch(state.mesh.basis(), f);
 }
 
 }
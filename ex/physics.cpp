@@ -5,122 +5,251 @@
 #include "p3a_for_each.hpp"
 
 #include "dgt_amr.hpp"
+#include "dgt_dispatch.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_interp.hpp"
 #include "dgt_interp_simd.hpp"
+#include "dgt_reduce.hpp"
 #include "dgt_spatial.hpp"
+#include "dgt_tensor.hpp"
 #include "dgt_views.hpp"
 
 #include "hydro.hpp"
 
 namespace hydro {
 
-static void handle_error_code(
-    State const& state,
-    std::string const& function) {
+static std::string get_error_name(int code) {
+  if (code == INVALID_PRESSURE) return "invalid pressure";
+  if (code == INVALID_WAVE_SPEED) return "invalid wave speed";
+  return "unknown error";
+}
+
+static std::string get_kernel_name(int kernel) {
+  if (kernel == TIME_STEP_KERNEL) return "compute_stable_time_step";
+  if (kernel == INTR_FACE_KERNEL) return "compute_intr_face_integral";
+  if (kernel == BORDER_FLUX_KERNEL) return "compute_border_fluxes";
+  if (kernel == AMR_BORDER_FLUX_KERNEL) return "compute_amr_border_fluxes";
+  if (kernel == VOL_INTEGRAL_KERNEL) return "compute_volume_integral";
+  return "unknown kernel";
+}
+
+void check_errors(State& state) {
   CALI_CXX_MARK_FUNCTION;
-  std::int8_t host_error;
-  p3a::copy(p3a::execution::par,
-      state.error_code.begin(), state.error_code.end(), &host_error);
-  if (host_error == 1) {
-    throw std::runtime_error(
-        "error_code - invalid pressure, " + function);
-  }
-  if (host_error == 2) {
-    throw std::runtime_error(
-        "error code - invalid wave speed, " + function);
-  }
+  dgt::ErrorRecord const record = state.error.check();
+  if (record.code == 0) return;
+  state.error.reset();
+  throw std::runtime_error(
+      "error code - " + get_error_name(record.code) +
+      ", " + get_kernel_name(record.kernel) +
+      ", block " + std::to_string(record.block) +
+      ", cell " + std::to_string(record.cell));
 }
 
-double compute_stable_time_step(State& state, Block const& block) {
+dgt::ReduceValues compute_step_values(
+    State& state,
+    bool dt,
+    bool tallies,
+    bool errors) {
   CALI_CXX_MARK_FUNCTION;
-  int const dim = block.dim();
-  int const p = block.basis().p;
-  double const factor = 2*p+1;
+  dgt::BlockPack const pack = state.mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  Basis const b = state.mesh.basis();
+  int const dim = pack.dim();
+  int const nintr_pts = dgt::num_pts(b.dim, b.p);
+  int const nfine_pts = b.wt_fine.extent(0);
+  double const factor = 2*b.p+1;
   double const gamma = state.in.gamma;
-  p3a::vector3<double> const dx = block.dx();
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  p3a::simd_view<double***> U = block.simd_soln(0);
-  volatile std::int8_t* error_ptr = state.error_code.begin();
+  int const exact = state.in.exact_solution;
+  dgt::ErrorFlag const error = state.error;
+  int const nerr = errors ? NERR : 0;
+  int const err_offset = tallies ? NEQ : 0;
+  dgt::ReduceValues const identity =
+    dgt::make_reduce_values(dt ? 1 : 0, err_offset + nerr);
   auto f = [=] P3A_DEVICE (
+      int const block,
       p3a::vector3<int> const& cell_ijk,
-      p3a::device_simd_mask<double> const& mask) {
-    p3a::device_simd<double> c;
+      dgt::ReduceValues& r) P3A_NEVER_INLINE {
+    dgt::PackedBlock const& pb = pack.block(block);
+    View<double***> const U = pack.soln(block, 0);
     int const cell = cell_grid.index(cell_ijk);
-    p3a::static_vector<p3a::device_simd<double>, NEQ> const U_avg =
-      dgt::gather_avg<NEQ>(U, cell, mask);
-    p3a::vector3<p3a::device_simd<double>> const v_avg =
-      get_vec3(U_avg, MM) / U_avg[RH];
-    c = get_wave_speed(U_avg, gamma);
-    if (any_of((c != c) && mask)) { *error_ptr = 2; }
-    p3a::device_simd<double> dvdx = 0.;
-    for (int axis = 0; axis < dim; ++axis) {
-      dvdx += (abs(v_avg[axis]) + c) / dx[axis];
+    if (dt) {
+      p3a::static_vector<double, NEQ> const U_avg = dgt::gather_avg<NEQ>(U, cell);
+      p3a::vector3<double> const v_avg = get_vec3(U_avg, MM) / U_avg[RH];
+      double const c = get_wave_speed(U_avg, gamma);
+      if (c != c) { error.raise(INVALID_WAVE_SPEED, TIME_STEP_KERNEL, pb.id, cell); }
+      double dvdx = 0.;
+      for (int axis = 0; axis < dim; ++axis) {
+        dvdx += (std::abs(v_avg[axis]) + c) / pb.dx[axis];
+      }
+      r.vals[0] = 1./(factor*dvdx);
+    }
+    if (tallies) {
+      for (int eq = 0; eq < NEQ; ++eq) {
+        double tally = 0.;
+        for (int pt = 0; pt < nintr_pts; ++pt) {
+          double const wt = b.wt_intr(pt);
+          double const U_eq = dgt::interp_scalar_intr(U, b, cell, pt, eq);
+          tally += U_eq * wt * pb.cell_detJ;
+        }
+        r.vals[r.nmin + eq] = tally;
+      }
+    }
+    if (errors) {
+      double* err = r.vals + r.nmin + err_offset;
+      for (int pt = 0; pt < nfine_pts; ++pt) {
+        double const wt = b.wt_fine(pt);
+        p3a::vector3<double> const x = dgt::get_fine_x(b, pt, cell_ijk, pb.origin, pb.dx);
+        double const u = get_exact_state(exact, x, dim, gamma)[RH];
+        double const uh = dgt::interp_scalar_fine(U, b, cell, pt, RH);
+        err[L1] += std::abs(u-uh) * wt * pb.cell_detJ;
+        err[L2] += (u-uh)*(u-uh) * wt * pb.cell_detJ;
+      }
     }
-    p3a::device_simd<double> const dt = 1./(factor*dvdx);
-    return dt;
   };
-  double constexpr identity_value = p3a::maximum_value<double>();
-  auto constexpr binary_op = p3a::minimizer<double>();
-  double const result = p3a::simd_transform_reduce(
-      p3a::execution::par, cell_grid, identity_value, binary_op, f);
-  handle_error_code(state, "compute_stable_time_step");
-  return result;
+  return dgt::reduce_block_cells(p3a::execution::par, pack, identity, f);
 }
 
-void compute_intr_fluxes(
+template <class O>
+[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
+p3a::static_vector<p3a::device_simd<double>, NEQ> get_intr_hllc_flux(
+    dgt::BlockPack const& pack,
+    dgt::BasisTable const& b,
+    dgt::ErrorFlag const& error,
+    int block,
+    int const cell[ndirs],
+    int axis,
+    int pt,
+    int soln_idx,
+    bool use_traces,
+    double gamma,
+    p3a::device_simd_mask<double> const& mask) {
+  p3a::device_simd<double> P[ndirs], c[ndirs];
+  p3a::static_vector<p3a::device_simd<double>, NEQ> U[ndirs], F[ndirs];
+  p3a::simd_view<double***> const soln = pack.simd_soln(block, soln_idx);
+  p3a::simd_view<double***> const trace = pack.simd_trace(block);
+  for (int lr = 0; lr < ndirs; ++lr) {
+    int const ilr = dgt::invert_dir(lr);
+    U[lr] = use_traces ?
+      dgt::gather_trace<NEQ>(trace, cell[lr], axis, ilr, pt, O::nside_pts, mask) :
+      dgt::interp_vec_side<NEQ, O::nmodes>(soln, b, cell[lr], axis, ilr, pt, mask);
+    P[lr] = get_pressure(U[lr], gamma);
+    c[lr] = get_wave_speed(U[lr], gamma);
+    F[lr] = get_flux(U[lr], P[lr], axis);
+    error.raise(INVALID_PRESSURE, INTR_FACE_KERNEL, pack.block(block).id, cell[lr], (P[lr] != P[lr]) && mask);
+    error.raise(INVALID_WAVE_SPEED, INTR_FACE_KERNEL, pack.block(block).id, cell[lr], (c[lr] != c[lr]) && mask);
+  }
+  return get_hllc_flux(U, F, P, c, axis);
+}
+
+template <class O>
+static void compute_intr_face_integral(
     State& state,
-    Block& block,
     int axis,
-    int soln_idx) {
-  CALI_CXX_MARK_FUNCTION;
-  int const dim = block.dim();
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  p3a::grid3 const side_grid = dgt::generalize(dgt::get_side_grid(g, axis));
-  p3a::subgrid3 const intr_sides = dgt::generalize(dgt::get_intr_sides(g, axis));
-  Basis const b = block.basis();
-  int const nside_pts = dgt::num_pts(dim-1, b.p);
+    int soln_idx,
+    bool store_flux) {
+  dgt::BlockPack const pack = state.mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  p3a::grid3 const side_grid = pack.side_grid(axis);
+  p3a::subgrid3 const intr_sides = dgt::get_intr_sides(cell_grid, axis);
+  dgt::BasisTable const b = state.mesh.basis().table;
+  int const ncells = cell_grid.extents()[axis];
   double const gamma = state.in.gamma;
-  p3a::simd_view<double***> soln = block.simd_soln(soln_idx);
-  p3a::simd_view<double***> fluxes = block.simd_flux(axis);
-  volatile std::int8_t* error_ptr = state.error_code.begin();
-  auto f = [=] P3A_DEVICE (
-      p3a::vector3<int> const& side_ijk,
-      p3a::device_simd_mask<double> const& mask) {
-    p3a::device_simd<double> P[ndirs], c[ndirs];
-    p3a::static_vector<p3a::device_simd<double>, NEQ> U[ndirs], F[ndirs], F_hllc;
-    int const side = side_grid.index(side_ijk);
-    for (int pt = 0; pt < nside_pts; ++pt) {
-      for (int lr = 0; lr < ndirs; ++lr) {
+  bool const use_traces = state.in.trace_cache;
+  dgt::ErrorFlag const error = state.error;
+  if (axis == 0) {
+    for (int lr = right; lr >= left; --lr) {
+      auto f = [=] P3A_DEVICE (
+          int const block,
+          p3a::vector3<int> const& side_ijk,
+          p3a::device_simd_mask<double> const& mask) {
+        int cell[ndirs];
+        p3a::static_vector<p3a::device_simd<double>, NEQ> F_hllc;
+        p3a::simd_view<double***> const fluxes = pack.simd_flux(block, axis);
+        p3a::simd_view<double***> const R = pack.simd_resid(block);
+        double const detJ = pack.block(block).side_detJ[axis];
+        int const side = side_grid.index(side_ijk);
         int const ilr = dgt::invert_dir(lr);
-        p3a::vector3<int> const cell_ijk = dgt::get_sides_adj_cell(side_ijk, axis, lr);
-        int const cell = cell_grid.index(cell_ijk);
-        U[lr] = dgt::interp_vec_side<NEQ>(soln, b, cell, axis, ilr, pt, mask);
-        P[lr] = get_pressure(U[lr], gamma);
-        c[lr] = get_wave_speed(U[lr], gamma);
-        F[lr] = get_flux(U[lr], P[lr], axis);
-        if (any_of((P[lr] != P[lr]) && mask)) { *error_ptr = 1; }
-        if (any_of((c[lr] != c[lr]) && mask)) { *error_ptr = 2; }
+        double const sgn = dgt::get_dir_sign(ilr);
+        for (int d = 0; d < ndirs; ++d) {
+          cell[d] = cell_grid.index(dgt::get_sides_adj_cell(side_ijk, axis, d));
+        }
+        for (int pt = 0; pt < O::nside_pts; ++pt) {
+          if (lr == right) {
+            F_hllc = get_intr_hllc_flux<O>(pack, b, error, block, cell, axis, pt, soln_idx, use_traces, gamma, mask);
+            for (int eq = 0; eq < NEQ; ++eq) {
+              fluxes.store(F_hllc[eq], side, pt, eq, mask);
+            }
+          } else {
+            F_hllc = dgt::gather_pt<NEQ>(fluxes, side, pt, mask);
+          }
+          double const wt = b.wt_side(pt);
+          for (int m = 0; m < O::nmodes; ++m) {
+            double const phi = b.phi_side(axis, ilr, pt, m);
+            for (int eq = 0; eq < NEQ; ++eq) {
+              R.sum_store(-sgn * F_hllc[eq] * phi * detJ * wt, cell[lr], eq, m, mask);
+            }
+          }
+        }
+      };
+      dgt::simd_for_each_block_subgrid<double>(p3a::execution::par, pack, intr_sides, f);
+    }
+    return;
+  }
+  for (int parity = 0; parity < 2; ++parity) {
+    p3a::vector3<int> lower = intr_sides.lower();
+    p3a::vector3<int> upper = intr_sides.upper();
+    lower[axis] = 0;
+    upper[axis] = (ncells - parity) / 2;
+    p3a::subgrid3 const faces(lower, upper);
+    auto f = [=] P3A_DEVICE (
+        int const block,
+        p3a::vector3<int> const& face_ijk,
+        p3a::device_simd_mask<double> const& mask) {
+      int cell[ndirs];
+      p3a::simd_view<double***> const fluxes = pack.simd_flux(block, axis);
+      p3a::simd_view<double***> const R = pack.simd_resid(block);
+      double const detJ = pack.block(block).side_detJ[axis];
+      p3a::vector3<int> side_ijk = face_ijk;
+      side_ijk[axis] = 1 + parity + 2 * face_ijk[axis];
+      int const side = side_grid.index(side_ijk);
+      for (int lr = 0; lr < ndirs; ++lr) {
+        cell[lr] = cell_grid.index(dgt::get_sides_adj_cell(side_ijk, axis, lr));
       }
-      F_hllc = get_hllc_flux(U, F, P, c, axis);
-      for (int eq = 0; eq < NEQ; ++eq) {
-        fluxes.store(F_hllc[eq], side, pt, eq, mask);
+      for (int pt = 0; pt < O::nside_pts; ++pt) {
+        p3a::static_vector<p3a::device_simd<double>, NEQ> const F_hllc =
+          get_intr_hllc_flux<O>(pack, b, error, block, cell, axis, pt, soln_idx, use_traces, gamma, mask);
+        if (store_flux) {
+          for (int eq = 0; eq < NEQ; ++eq) {
+            fluxes.store(F_hllc[eq], side, pt, eq, mask);
+          }
+        }
+        double const wt = b.wt_side(pt);
+        for (int lr = 0; lr < ndirs; ++lr) {
+          int const ilr = dgt::invert_dir(lr);
+          double const sgn = dgt::get_dir_sign(ilr);
+          for (int m = 0; m < O::nmodes; ++m) {
+            double const phi = b.phi_side(axis, ilr, pt, m);
+            for (int eq = 0; eq < NEQ; ++eq) {
+              R.sum_store(-sgn * F_hllc[eq] * phi * detJ * wt, cell[lr], eq, m, mask);
+            }
+          }
+        }
       }
-    }
-  };
-  p3a::simd_for_each<double>(p3a::execution::par, intr_sides, f);
-  handle_error_code(state, "compute_intr_fluxes");
+    };
+    dgt::simd_for_each_block_subgrid<double>(p3a::execution::par, pack, faces, f);
+  }
 }
 
-[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
-p3a::static_vector<double, NEQ> gather_side(View<double***> soln, int bside, int pt) {
-  p3a::static_vector<double, NEQ> U;
-  for (int eq = 0; eq < NEQ; ++eq) {
-    U[eq] = soln(bside, pt, eq);
-  }
-  return U;
+void compute_intr_face_integral(
+    State& state,
+    int axis,
+    int soln_idx,
+    bool store_flux) {
+  CALI_CXX_MARK_FUNCTION;
+  auto f = [&] (auto order) {
+    compute_intr_face_integral<decltype(order)>(state, axis, soln_idx, store_flux);
+  };
+  dgt::dispatch(state.mesh.basis(), f);
 }
 
 void compute_border_fluxes(
@@ -138,42 +267,34 @@ void compute_border_fluxes(
   int const nside_pts = dgt::num_pts(dim-1, b.p);
   double const gamma = state.in.gamma;
   Border const& border = block.border(axis, dir);
-  p3a::static_array<View<double***>, ndirs> bsoln = border.soln();
-  View<double***> fluxes = block.flux(axis);
-  volatile std::int8_t* error_ptr = state.error_code.begin();
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& side_ijk) {
-    double P[ndirs], c[ndirs];
-    p3a::static_vector<double, NEQ> U[ndirs], F[ndirs], F_hllc;
+  p3a::static_array<p3a::simd_view<double***>, ndirs> bsoln = border.simd_soln();
+  p3a::simd_view<double***> fluxes = block.simd_flux(axis);
+  int const block_id = block.id();
+  dgt::ErrorFlag const error = state.error;
+  auto f = [=] P3A_DEVICE (
+      p3a::vector3<int> const& side_ijk,
+      p3a::device_simd_mask<double> const& mask) {
+    p3a::device_simd<double> P[ndirs], c[ndirs];
+    p3a::static_vector<p3a::device_simd<double>, NEQ> U[ndirs], F[ndirs], F_hllc;
     p3a::vector3<int> const bside_ijk = dgt::get_border_ijk(side_ijk, axis);
     int const side = side_grid.index(side_ijk);
     int const bside = bside_grid.index(bside_ijk);
     for (int pt = 0; pt < nside_pts; ++pt) {
       for (int lr = 0; lr < ndirs; ++lr) {
-        U[lr] = gather_side(bsoln[lr], bside, pt);
+        U[lr] = dgt::gather_pt<NEQ>(bsoln[lr], bside, pt, mask);
         P[lr] = get_pressure(U[lr], gamma);
         c[lr] = get_wave_speed(U[lr], gamma);
         F[lr] = get_flux(U[lr], P[lr], axis);
-        if (P[lr] != P[lr]) { *error_ptr = 1; }
-        if (c[lr] != c[lr]) { *error_ptr = 2; }
+        error.raise(INVALID_PRESSURE, BORDER_FLUX_KERNEL, block_id, side, (P[lr] != P[lr]) && mask);
+        error.raise(INVALID_WAVE_SPEED, BORDER_FLUX_KERNEL, block_id, side, (c[lr] != c[lr]) && mask);
       }
       F_hllc = get_hllc_flux(U, F, P, c, axis);
       for (int eq = 0; eq < NEQ; ++eq) {
-        fluxes(side, pt, eq) = F_hllc[eq];
+        fluxes.store(F_hllc[eq], side, pt, eq, mask);
       }
     }
   };
-  p3a::for_each(p3a::execution::par, border_sides, f);
-  handle_error_code(state, "compute_border_fluxes");
-}
-
-[[nodiscard]] P3A_ALWAYS_INLINE P3A_HOST_DEVICE inline
-p3a::static_vector<double, NEQ> gather_amr_side(
-    View<double****> soln, int bside, int child, int pt) {
-  p3a::static_vector<double, NEQ> U;
-  for (int eq = 0; eq < NEQ; ++eq) {
-    U[eq] = soln(bside, child, pt, eq);
-  }
-  return U;
+  p3a::simd_for_each<double>(p3a::execution::par, border_sides, f);
 }
 
 void compute_amr_border_fluxes(
@@ -185,117 +306,167 @@ void compute_amr_border_fluxes(
   int const dim = block.dim();
   p3a::grid3 const g = block.cell_grid();
   p3a::subgrid3 const border_sides = dgt::generalize(dgt::get_adj_sides(g, axis, dir));
-  p3a::grid3 const bside_grid(border_sides.extents());
+  p3a::vector3<int> const nbsides(border_sides.size(), 1, 1);
+  p3a::subgrid3 const bsides(p3a::grid3(nbsides));
   Basis const b = block.basis();
-  int const nside_pts = dgt::num_pts(dim-1, b.p);
-  int const nchild_sides = dgt::num_child(dim-1);
+  int const nchild_side_pts = dgt::num_child(dim-1) * dgt::num_pts(dim-1, b.p);
   double const gamma = state.in.gamma;
   Border const& border = block.border(axis, dir);
-  p3a::static_array<View<double****>, ndirs> bsoln = border.amr_soln();
-  View<double****> fluxes = border.amr_flux();
-  volatile std::int8_t* error_ptr = state.error_code.begin();
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& side_ijk) {
-    double P[ndirs], c[ndirs];
-    p3a::static_vector<double, NEQ> U[ndirs], F[ndirs], F_hllc;
-    p3a::vector3<int> const bside_ijk = dgt::get_border_ijk(side_ijk, axis);
-    int const bside = bside_grid.index(bside_ijk);
-    for (int child = 0; child < nchild_sides; ++child) {
-      for (int pt = 0; pt < nside_pts; ++pt) {
-        for (int lr = 0; lr < ndirs; ++lr) {
-          U[lr] = gather_amr_side(bsoln[lr], bside, child, pt);
-          P[lr] = get_pressure(U[lr], gamma);
-          c[lr] = get_wave_speed(U[lr], gamma);
-          F[lr] = get_flux(U[lr], P[lr], axis);
-          if (P[lr] != P[lr]) { *error_ptr = 1; }
-          if (c[lr] != c[lr]) { *error_ptr = 2; }
-        }
-        F_hllc = get_hllc_flux(U, F, P, c, axis);
-        for (int eq = 0; eq < NEQ; ++eq) {
-          fluxes(bside, child, pt, eq) = F_hllc[eq];
-        }
+  p3a::static_array<p3a::simd_view<double***>, ndirs> bsoln = border.simd_amr_soln();
+  p3a::simd_view<double***> fluxes = border.simd_amr_flux();
+  int const block_id = block.id();
+  dgt::ErrorFlag const error = state.error;
+  auto f = [=] P3A_DEVICE (
+      p3a::vector3<int> const& bside_ijk,
+      p3a::device_simd_mask<double> const& mask) {
+    p3a::device_simd<double> P[ndirs], c[ndirs];
+    p3a::static_vector<p3a::device_simd<double>, NEQ> U[ndirs], F[ndirs], F_hllc;
+    int const bside = bside_ijk.x();
+    for (int child_pt = 0; child_pt < nchild_side_pts; ++child_pt) {
+      for (int lr = 0; lr < ndirs; ++lr) {
+        U[lr] = dgt::gather_pt<NEQ>(bsoln[lr], bside, child_pt, mask);
+        P[lr] = get_pressure(U[lr], gamma);
+        c[lr] = get_wave_speed(U[lr], gamma);
+        F[lr] = get_flux(U[lr], P[lr], axis);
+        error.raise(INVALID_PRESSURE, AMR_BORDER_FLUX_KERNEL, block_id, bside, (P[lr] != P[lr]) && mask);
+        error.raise(INVALID_WAVE_SPEED, AMR_BORDER_FLUX_KERNEL, block_id, bside, (c[lr] != c[lr]) && mask);
+      }
+      F_hllc = get_hllc_flux(U, F, P, c, axis);
+      for (int eq = 0; eq < NEQ; ++eq) {
+        fluxes.store(F_hllc[eq], bside, child_pt, eq, mask);
       }
     }
   };
-  p3a::for_each(p3a::execution::par, border_sides, f);
-  handle_error_code(state, "compute_amr_border_fluxes");
+  p3a::simd_for_each<double>(p3a::execution::par, bsides, f);
 }
 
-void compute_vol_integral(State& state, Block& block, int soln_idx) {
+void zero_residual(State& state) {
   CALI_CXX_MARK_FUNCTION;
-  int const dim = block.dim();
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  p3a::vector3<double> const dx = block.dx();
-  double const detJ = block.cell_detJ();
-  Basis const b = block.basis();
+  dgt::BlockPack const pack = state.mesh.pack();
+  int const nentries = pack.cell_grid().size() * pack.nmodal_eq() * pack.nmodes();
+  auto f = [=] P3A_DEVICE (int const block, int const i) {
+    pack.block(block).resid[i] = 0.;
+  };
+  dgt::for_each_block_entry(p3a::execution::par, pack, nentries, f);
+}
+
+template <class O>
+static void compute_vol_integral(State& state, int soln_idx) {
+  dgt::BlockPack const pack = state.mesh.pack();
+  int const dim = O::dim;
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  dgt::BasisTable const b = state.mesh.basis().table;
   double const gamma = state.in.gamma;
-  int const nintr_pts = dgt::num_pts(dim, b.p);
-  p3a::simd_view<double***> R = block.simd_resid();
-  p3a::simd_view<double***> soln = block.simd_soln(soln_idx);
-  volatile std::int8_t* error_ptr = state.error_code.begin();
-  auto f = [=] P3A_DEVICE (
-      p3a::vector3<int> const& cell_ijk,
-      p3a::device_simd_mask<double> const& mask) {
-    p3a::device_simd<double> P, val;
-    p3a::static_vector<p3a::device_simd<double>, NEQ> U, F;
-    int const cell = cell_grid.index(cell_ijk);
-    for (int pt = 0; pt < nintr_pts; ++pt) {
-      double const wt = b.wt_intr(pt);
-      U = dgt::interp_vec_intr<NEQ>(soln, b, cell, pt, mask);
-      //for (int axis = 0; axis < b.dim; ++axis) {
-      //   dUdx[axis] = dgt::d_interp_vec_intr<NEQ>(soln, b, dx, axis, cell, pt, mask);
-      //}
-      P = get_pressure(U, gamma);
-      if (any_of((P != P) && mask)) { *error_ptr = 1; }
+  int const nintr_pts = O::nintr_pts;
+  dgt::ErrorFlag const error = state.error;
+  if constexpr (O::tensor) {
+    auto f = [=] P3A_DEVICE (
+        int const block,
+        p3a::vector3<int> const& cell_ijk,
+        p3a::device_simd_mask<double> const& mask) {
+      p3a::device_simd<double> U_pts[NEQ][O::nintr_pts];
+      p3a::device_simd<double> G[NEQ][O::nintr_pts];
+      p3a::device_simd<double> r[O::nmodes];
+      p3a::device_simd<double> P;
+      p3a::static_vector<p3a::device_simd<double>, NEQ> U, F;
+      dgt::PackedBlock const& pb = pack.block(block);
+      p3a::simd_view<double***> const R = pack.simd_resid(block);
+      p3a::simd_view<double***> const soln = pack.simd_soln(block, soln_idx);
+      int const cell = cell_grid.index(cell_ijk);
+      for (int eq = 0; eq < NEQ; ++eq) {
+        dgt::tensor_interp_intr<O>(soln, b, cell, eq, U_pts[eq], mask);
+      }
       for (int axis = 0; axis < dim; ++axis) {
-        F = get_flux(U, P, axis);
+        double const scale = pb.cell_detJ * (2./pb.dx[axis]);
+        for (int pt = 0; pt < nintr_pts; ++pt) {
+          double const wt = b.wt_intr(pt);
+          for (int eq = 0; eq < NEQ; ++eq) {
+            U[eq] = U_pts[eq][pt];
+          }
+          P = get_pressure(U, gamma);
+          error.raise(INVALID_PRESSURE, VOL_INTEGRAL_KERNEL, pb.id, cell, (P != P) && mask);
+          F = get_flux(U, P, axis);
+          for (int eq = 0; eq < NEQ; ++eq) {
+            G[eq][pt] = F[eq] * wt * scale;
+          }
+        }
         for (int eq = 0; eq < NEQ; ++eq) {
-          for (int m = 0; m < b.nmodes; ++m) {
-            double const dphi_dx = b.dphi_intr(axis, pt, m) * (2./dx[axis]);
-            val = F[eq] * dphi_dx * detJ * wt;
-            R.sum_store(val, cell, eq, m, mask);
+          dgt::tensor_integrate_intr<O>(b, axis, G[eq], r);
+          for (int t = 0; t < O::nmodes; ++t) {
+            R.sum_store(r[t], cell, eq, b.tensor_mode(t), mask);
           }
         }
       }
-    }
+    };
+    dgt::simd_for_each_block_cell<double>(p3a::execution::par, pack, f);
+  } else {
+    auto f = [=] P3A_DEVICE (
+        int const block,
+        p3a::vector3<int> const& cell_ijk,
+        p3a::device_simd_mask<double> const& mask) {
+      p3a::device_simd<double> P;
+      p3a::static_vector<p3a::device_simd<double>, NEQ> U, F;
+      dgt::PackedBlock const& pb = pack.block(block);
+      p3a::simd_view<double***> const R = pack.simd_resid(block);
+      p3a::simd_view<double***> const soln = pack.simd_soln(block, soln_idx);
+      int const cell = cell_grid.index(cell_ijk);
+      for (int pt = 0; pt < nintr_pts; ++pt) {
+        double const wt = b.wt_intr(pt);
+        U = dgt::interp_vec_intr<NEQ, O::nmodes>(soln, b, cell, pt, mask);
+        P = get_pressure(U, gamma);
+        error.raise(INVALID_PRESSURE, VOL_INTEGRAL_KERNEL, pb.id, cell, (P != P) && mask);
+        for (int axis = 0; axis < dim; ++axis) {
+          F = get_flux(U, P, axis);
+          for (int eq = 0; eq < NEQ; ++eq) {
+            for (int m = 0; m < O::nmodes; ++m) {
+              double const dphi_dx = b.dphi_intr(axis, pt, m) * (2./pb.dx[axis]);
+              R.sum_store(F[eq] * dphi_dx * pb.cell_detJ * wt, cell, eq, m, mask);
+            }
+          }
+        }
+      }
+    };
+    dgt::simd_for_each_block_cell<double>(p3a::execution::par, pack, f);
+  }
+}
+
+void compute_vol_integral(State& state, int soln_idx) {
+  CALI_CXX_MARK_FUNCTION;
+  auto f = [&] (auto order) {
+    compute_vol_integral<decltype(order)>(state, soln_idx);
   };
-  p3a::simd_for_each<double>(p3a::execution::par, cell_grid, f);
-  handle_error_code(state, "compute_volume_integral");
+  dgt::dispatch(state.mesh.basis(), f);
 }
 
-void compute_side_integral(Block& block, int axis) {
+void compute_border_side_integral(State& state, int axis) {
   CALI_CXX_MARK_FUNCTION;
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  p3a::grid3 const side_grid = dgt::generalize(dgt::get_side_grid(g, axis));
-  double const detJ = block.side_detJ(axis);
-  Basis const b = block.basis();
-  int const nside_pts = dgt::num_pts(block.dim()-1, b.p);
-  p3a::simd_view<double***> F = block.simd_flux(axis);
-  p3a::simd_view<double***> R = block.simd_resid();
-  auto f = [=] P3A_DEVICE (
-      p3a::vector3<int> const& cell_ijk,
-      p3a::device_simd_mask<double> const& mask) {
-    p3a::device_simd<double> F_eq, val;
-    int const cell = cell_grid.index(cell_ijk);
-    for (int dir = 0; dir < ndirs; ++dir) {
+  dgt::BlockPack const pack = state.mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  p3a::grid3 const side_grid = pack.side_grid(axis);
+  dgt::BasisTable const b = state.mesh.basis().table;
+  int const nside_pts = pack.nside_pts();
+  for (int dir = 0; dir < ndirs; ++dir) {
+    p3a::subgrid3 const border_cells = dgt::get_adj_cells(cell_grid, axis, dir);
+    double const sgn = dgt::get_dir_sign(dir);
+    auto f = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+      double const detJ = pack.block(block).side_detJ[axis];
+      View<double***> const F = pack.flux(block, axis);
+      View<double***> const R = pack.resid(block);
+      int const cell = cell_grid.index(cell_ijk);
       p3a::vector3<int> const side_ijk = dgt::get_cells_adj_side(cell_ijk, axis, dir);
       int const side = side_grid.index(side_ijk);
-      double const sgn = dgt::get_dir_sign(dir);
       for (int pt = 0; pt < nside_pts; ++pt) {
         double const wt = b.wt_side(pt);
-        for (int m = 0; m < b.nmodes; ++m) {
+        for (int m = 0; m < b.nmodes(); ++m) {
           double const phi = b.phi_side(axis, dir, pt, m);
           for (int eq = 0; eq < NEQ; ++eq) {
-            F_eq = F.load(side, pt, eq, mask);
-            val = -sgn * F_eq * phi * detJ * wt;
-            R.sum_store(val, cell, eq, m, mask);
+            R(cell, eq, m) -= sgn * F(side, pt, eq) * phi * detJ * wt;
           }
         }
       }
-    }
-  };
-  p3a::simd_for_each<double>(p3a::execution::par, cell_grid, f);
+    };
+    dgt::for_each_block_subgrid(p3a::execution::par, pack, border_cells, f);
+  }
 }
 
 void compute_amr_side_integral(Block& block, int axis, int dir) {
@@ -335,16 +506,16 @@ void compute_amr_side_integral(Block& block, int axis, int dir) {
   p3a::for_each(p3a::execution::par, border_cells, f);
 }
 
-void compute_gravity_source(Block& block, int soln_idx, double g, int axis) {
+void compute_gravity_source(State& state, int soln_idx, double g, int axis) {
   CALI_CXX_MARK_FUNCTION;
-  Basis const b = block.basis();
-  int const dim = block.dim();
-  int const nintr_pts = dgt::num_pts(dim, b.p);
-  p3a::grid3 const cell_grid = dgt::generalize(block.cell_grid());
-  double const detJ = block.cell_detJ();
-  View<double***> R = block.resid();
-  View<double***> U = block.soln(soln_idx);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
+  dgt::BlockPack const pack = state.mesh.pack();
+  Basis const b = state.mesh.basis();
+  int const nintr_pts = dgt::num_pts(pack.dim(), b.p);
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  auto f = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+    double const detJ = pack.block(block).cell_detJ;
+    View<double***> const R = pack.resid(block);
+    View<double***> const U = pack.soln(block, soln_idx);
     int const cell = cell_grid.index(cell_ijk);
     for (int pt = 0; pt < nintr_pts; ++pt) {
       double const wt = b.wt_intr(pt);
@@ -357,24 +528,25 @@ void compute_gravity_source(Block& block, int soln_idx, double g, int axis) {
       }
     }
   };
-  p3a::for_each(p3a::execution::par, cell_grid, f);
+  dgt::for_each_block_cell(p3a::execution::par, pack, f);
 }
 
-void advance_explicitly(Block& block, int from_idx, int to_idx, double dt) {
+void advance_explicitly(State& state, int from_idx, int to_idx, double dt) {
   CALI_CXX_MARK_FUNCTION;
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  double const detJ = block.cell_detJ();
-  Basis const b = block.basis();
-  p3a::simd_view<double***> from = block.simd_soln(from_idx);
-  p3a::simd_view<double***> to = block.simd_soln(to_idx);
-  p3a::simd_view<double***> R = block.simd_resid();
+  dgt::BlockPack const pack = state.mesh.pack();
+  p3a::grid3 const cell_grid = pack.cell_grid();
+  dgt::BasisTable const b = state.mesh.basis().table;
   auto f = [=] P3A_DEVICE (
+      int const block,
       p3a::vector3<int> const& cell_ijk,
       p3a::device_simd_mask<double> const& mask) {
     p3a::device_simd<double> from_eq, R_eq, val;
+    double const detJ = pack.block(block).cell_detJ;
+    p3a::simd_view<double***> const from = pack.simd_soln(block, from_idx);
+    p3a::simd_view<double***> const to = pack.simd_soln(block, to_idx);
+    p3a::simd_view<double***> const R = pack.simd_resid(block);
     int const cell = cell_grid.index(cell_ijk);
-    for (int m = 0; m < b.nmodes; ++m) {
+    for (int m = 0; m < b.nmodes(); ++m) {
       double const mass = detJ * b.mass(m);
       for (int eq = 0; eq < NEQ; ++eq) {
         from_eq = from.load(cell, eq, m, mask);
@@ -384,7 +556,7 @@ void advance_explicitly(Block& block, int from_idx, int to_idx, double dt) {
       }
     }
   };
-  p3a::simd_for_each<double>(p3a::execution::par, cell_grid, f);
+  dgt::simd_for_each_block_cell<double>(p3a::execution::par, pack, f);
 }
 
 void reflect_boundary(Border& border) {
@@ -408,87 +580,4 @@ void reflect_boundary(Border& border) {
   p3a::for_each(p3a::execution::par, bside_grid, f);
 }
 
-double compute_tally(Block& block, int eq) {
-  CALI_CXX_MARK_FUNCTION;
-  p3a::grid3 const cell_grid = dgt::generalize(block.cell_grid());
-  double const detJ = block.cell_detJ();
-  Basis const b = block.basis();
-  View<double***> U = block.soln(0);
-  int const nintr_pts = dgt::num_pts(b.dim, b.p);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) P3A_NEVER_INLINE {
-    double tally = 0.;
-    int const cell = cell_grid.index(cell_ijk);
-    for (int pt = 0; pt < nintr_pts; ++pt) {
-      double const wt = b.wt_intr(pt);
-      double const U_eq = dgt::interp_scalar_intr(U, b, cell, pt, eq);
-      tally += U_eq * wt * detJ;
-    }
-    return tally;
-  };
-  double constexpr identity_value = p3a::zero_value<double>();
-  auto constexpr binary_op = p3a::adder<double>();
-  double const result = p3a::transform_reduce(
-      p3a::execution::par, cell_grid, identity_value, binary_op, f);
-  return result;
-}
-
-double compute_L1_error(
-    Block& block,
-    View<double***> U_ex,
-    int eq) {
-  CALI_CXX_MARK_FUNCTION;
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  Basis const b = block.basis();
-  double const detJ = block.cell_detJ();
-  int const nfine_intr_pts = b.phi_fine.extent(0);
-  View<double***> Uh = block.soln(0);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
-    double error = 0.;
-    int const cell = cell_grid.index(cell_ijk);
-    for (int pt = 0; pt < nfine_intr_pts; ++pt) {
-      double const wt = b.wt_fine(pt);
-      double const u = U_ex(cell, pt, eq);
-      double const uh = dgt::interp_scalar_fine(Uh, b, cell, pt, eq);
-      error += std::abs(u-uh) * wt * detJ;
-    }
-    return error;
-  };
-  double constexpr identity_value = p3a::zero_value<double>();
-  auto constexpr binary_op = p3a::adder<double>();
-  double const result = p3a::transform_reduce(
-      p3a::execution::par, cell_grid, identity_value, binary_op, f);
-  return result;
-}
-
-double compute_L2_error(
-    Block& block,
-    View<double***> U_ex,
-    int eq) {
-  CALI_CXX_MARK_FUNCTION;
-  p3a::grid3 const g = block.cell_grid();
-  p3a::grid3 const cell_grid = dgt::generalize(g);
-  Basis const b = block.basis();
-  double const detJ = block.cell_detJ();
-  int const nfine_intr_pts = b.phi_fine.extent(0);
-  View<double***> Uh = block.soln(0);
-  auto f = [=] P3A_DEVICE (p3a::vector3<int> const& cell_ijk) {
-    double error = 0.;
-    int const cell = cell_grid.index(cell_ijk);
-    for (int pt = 0; pt < nfine_intr_pts; ++pt) {
-      double const wt = b.wt_fine(pt);
-      double const u = U_ex(cell, pt, eq);
-      double const uh = dgt::interp_scalar_fine(Uh, b, cell, pt, eq);
-      double const e = (u-uh)*(u-uh);
-      error += e * wt * detJ;
-    }
-    return error;
-  };
-  double constexpr identity_value = p3a::zero_value<double>();
-  auto constexpr binary_op = p3a::adder<double>();
-  double const result = p3a::transform_reduce(
-      p3a::execution::par, cell_grid, identity_value, binary_op, f);
-  return result;
-}
-
 }
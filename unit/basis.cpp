@@ -1,6 +1,7 @@
 #include "gtest/gtest.h"
 
 #include "dgt_basis.hpp"
+#include "dgt_dispatch.hpp"
 
 TEST(basis, init_tensor) {
   for (int dim = 1; dim <= 3; ++dim) {
@@ -67,3 +68,104 @@ TEST(basis, copying) {
   a = b;
   ASSERT_EQ(a.wt_intr.data(), b.wt_intr.data());
 }
+
+TEST(basis, dispatch) {
+  for (int dim = 1; dim <= 3; ++dim) {
+    for (int p = 0; p <= 2; ++p) {
+      for (bool tensor : {true, false}) {
+        auto f = [&] (auto order) {
+          using O = decltype(order);
+          ASSERT_EQ(O::dim, dim);
+          ASSERT_EQ(O::p, p);
+          ASSERT_EQ(O::tensor, tensor);
+          ASSERT_EQ(O::nmodes, dgt::num_modes(dim, p, tensor));
+          ASSERT_EQ(O::nside_pts, dgt::num_pts(dim-1, p));
+        };
+        dgt::dispatch(dim, p, tensor, f);
+      }
+    }
+  }
+  ASSERT_THROW(dgt::dispatch(1, 3, true, [] (auto) {}), std::runtime_error);
+}
+
+TEST(basis, tensor_tables) {
+  for (int dim = 1; dim <= 3; ++dim) {
+    for (int p = 0; p <= 2; ++p) {
+      dgt::HostBasis b;
+      b.init(dim, p, true);
+      p3a::vector3<int> const bounds = dgt::tensor_bounds(dim, p);
+      for (int pt = 0; pt < dgt::num_pts(dim, p); ++pt) {
+        for (int k = 0; k < bounds.z(); ++k) {
+          for (int j = 0; j < bounds.y(); ++j) {
+            for (int i = 0; i < bounds.x(); ++i) {
+              p3a::vector3<int> const deg(i, j, k);
+              p3a::vector3<int> qpt(pt % bounds.x(), 0, 0);
+              qpt.y() = (pt / bounds.x()) % bounds.y();
+              qpt.z() = pt / (bounds.x() * bounds.y());
+              double phi = 1.;
+              for (int d = 0; d < dim; ++d) {
+                phi *= b.phi_1d(qpt[d], deg[d]);
+              }
+              int const m = b.tensor_mode(dgt::index(deg, bounds));
+              ASSERT_NEAR(phi, b.phi_intr(pt, m), 1.e-14);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(basis, table) {
+  for (int dim = 1; dim <= 3; ++dim) {
+    for (int p = 0; p <= 2; ++p) {
+      for (bool tensor : {true, false}) {
+        dgt::HostBasis b;
+        b.init(dim, p, tensor);
+        dgt::BasisTable const& t = b.table;
+        ASSERT_EQ(t.nmodes(), b.nmodes);
+        for (int m = 0; m < b.nmodes; ++m) {
+          ASSERT_NEAR(t.mass(m), b.mass(m), 1.e-14);
+          for (int pt = 0; pt < dgt::num_pts(dim, p); ++pt) {
+            ASSERT_NEAR(t.phi_intr(pt, m), b.phi_intr(pt, m), 1.e-14);
+            for (int which_child = 0; which_child < dgt::num_child(dim); ++which_child) {
+              ASSERT_NEAR(t.phi_child_intr(which_child, pt, m),
+                  b.phi_child_intr(which_child, pt, m), 1.e-14);
+            }
+            for (int axis = 0; axis < dim; ++axis) {
+              ASSERT_NEAR(t.dphi_intr(axis, pt, m), b.dphi_intr(axis, pt, m), 1.e-14);
+            }
+          }
+          for (int axis = 0; axis < dim; ++axis) {
+            for (int dir = 0; dir < dgt::ndirs; ++dir) {
+              for (int pt = 0; pt < dgt::num_pts(dim-1, p); ++pt) {
+                ASSERT_NEAR(t.phi_side(axis, dir, pt, m), b.phi_side(axis, dir, pt, m), 1.e-14);
+                for (int which_child = 0; which_child < dgt::num_child(dim-1); ++which_child) {
+                  ASSERT_NEAR(t.phi_child_side(axis, dir, which_child, pt, m),
+                      b.phi_child_side(axis, dir, which_child, pt, m), 1.e-14);
+                }
+              }
+            }
+          }
+        }
+        for (int pt = 0; pt < dgt::num_pts(dim, p); ++pt) {
+          ASSERT_NEAR(t.wt_intr(pt), b.wt_intr(pt), 1.e-14);
+        }
+        for (int pt = 0; pt < dgt::num_pts(dim-1, p); ++pt) {
+          ASSERT_NEAR(t.wt_side(pt), b.wt_side(pt), 1.e-14);
+        }
+      }
+    }
+  }
+}
+
+TEST(basis, cache) {
+  dgt::Basis const& a = dgt::get_basis(2, 1, true);
+  dgt::Basis const& b = dgt::get_basis(2, 1, true);
+  dgt::Basis const& c = dgt::get_basis(2, 1, false);
+  ASSERT_EQ(&a, &b);
+  ASSERT_NE(&a, &c);
+  ASSERT_EQ(a.phi_intr.data(), b.phi_intr.data());
+  ASSERT_EQ(c.tensor, false);
+  ASSERT_THROW((void)dgt::get_basis(4, 1, true), std::runtime_error);
+}
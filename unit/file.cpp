@@ -1,9 +1,15 @@
+#include <cstring>
+#include <fstream>
+
 #include "gtest/gtest.h"
 
+#include "zlib.h"
+
 #include "dgt_amr.hpp"
 #include "dgt_defines.hpp"
 #include "dgt_file.hpp"
 #include "dgt_mesh.hpp"
+#include "dgt_output.hpp"
 
 TEST(file, base64) {
   double in_data[3];
@@ -66,3 +72,323 @@ TEST(file, vtk_read_ascii_2D) {
   ASSERT_EQ(mesh.fields()[0].ent_dim, 1);
   ASSERT_EQ(mesh.fields()[0].ncomps, 3);
 }
+
+static void fill_test_soln(dgt::Mesh& m) {
+  for (dgt::Node* leaf : m.owned_leaves()) {
+    dgt::View<double***> U = leaf->block.soln(0);
+    auto U_host = Kokkos::create_mirror_view(U);
+    for (std::size_t i = 0; i < U_host.span(); ++i) {
+      U_host.data()[i] = 1. / (1. + leaf->block.id() + i);
+    }
+    Kokkos::deep_copy(U, U_host);
+  }
+}
+
+static void expect_same_soln(dgt::Mesh const& in, dgt::Mesh const& out) {
+  ASSERT_EQ(in.owned_leaves().size(), out.owned_leaves().size());
+  for (std::size_t b = 0; b < in.owned_leaves().size(); ++b) {
+    ASSERT_EQ(in.owned_leaves()[b]->pt(), out.owned_leaves()[b]->pt());
+    auto U_in = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace(), in.owned_leaves()[b]->block.soln(0));
+    auto U_out = Kokkos::create_mirror_view_and_copy(
+        Kokkos::HostSpace(), out.owned_leaves()[b]->block.soln(0));
+    ASSERT_EQ(U_in.span(), U_out.span());
+    for (std::size_t i = 0; i < U_in.span(); ++i) {
+      ASSERT_EQ(U_in.data()[i], U_out.data()[i]);
+    }
+  }
+}
+
+TEST(file, binary_round_trip_2D) {
+  dgt::Mesh out;
+  dgt::Mesh in;
+  mpicpp::comm world = mpicpp::comm::world();
+  out.set_comm(&world);
+  in.set_comm(&world);
+  init_test_mesh(2, out);
+  out.allocate();
+  fill_test_soln(out);
+  dgt::binary::write_mesh("test", out);
+  dgt::binary::read_mesh("test.dgb", in);
+  ASSERT_EQ(in.dim(), 2);
+  ASSERT_EQ(in.basis().p, 1);
+  ASSERT_EQ(in.owned_leaves().size(), out.owned_leaves().size());
+  ASSERT_EQ(in.fields().size(), 1);
+  ASSERT_EQ(in.fields()[0].name, "test_field");
+  expect_same_soln(in, out);
+}
+
+TEST(file, ascii_round_trip_2D) {
+  dgt::Mesh out;
+  dgt::Mesh in;
+  mpicpp::comm world = mpicpp::comm::world();
+  out.set_comm(&world);
+  in.set_comm(&world);
+  init_test_mesh(2, out);
+  out.allocate();
+  fill_test_soln(out);
+  dgt::ascii::write_mesh("test_round_trip", out);
+  world.barrier();
+  dgt::ascii::read_mesh("test_round_trip.dga", in);
+  ASSERT_EQ(in.leaves().size(), out.leaves().size());
+  expect_same_soln(in, out);
+}
+
+TEST(file, output_queue) {
+  std::vector<int> order;
+  dgt::OutputQueue queue(2);
+  for (int i = 0; i < 8; ++i) {
+    queue.push([&order, i] () { order.push_back(i); });
+  }
+  queue.flush();
+  ASSERT_EQ(order.size(), 8);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(order[i], i);
+  }
+  queue.push([] () { throw std::runtime_error("output failed"); });
+  EXPECT_THROW(queue.flush(), std::runtime_error);
+  queue.flush();
+}
+
+TEST(file, ascii_read_missing_or_corrupt) {
+  mpicpp::comm world = mpicpp::comm::world();
+  dgt::Mesh missing;
+  missing.set_comm(&world);
+  ASSERT_THROW(dgt::ascii::read_mesh("test_missing.dga", missing), std::runtime_error);
+  if (world.rank() == 0) {
+    std::filesystem::create_directory("test_corrupt.dga");
+    std::ofstream file("test_corrupt.dga/mesh.dga");
+    file << "2 1 1\nnot a mesh\n";
+  }
+  world.barrier();
+  dgt::Mesh corrupt;
+  corrupt.set_comm(&world);
+  ASSERT_THROW(dgt::ascii::read_mesh("test_corrupt.dga", corrupt), std::runtime_error);
+}
+
+TEST(file, ascii_async_round_trip_2D) {
+  dgt::Mesh out;
+  dgt::Mesh in;
+  mpicpp::comm world = mpicpp::comm::world();
+  out.set_comm(&world);
+  in.set_comm(&world);
+  init_test_mesh(2, out);
+  out.allocate();
+  fill_test_soln(out);
+  {
+    dgt::OutputQueue queue;
+    dgt::ascii::write_mesh(queue, "test_async", out);
+  }
+  world.barrier();
+  dgt::ascii::read_mesh("test_async.dga", in);
+  expect_same_soln(in, out);
+}
+
+TEST(file, ascii_read_other_rank_count) {
+  dgt::Mesh out;
+  dgt::Mesh in;
+  dgt::Mesh expected;
+  mpicpp::comm world = mpicpp::comm::world();
+  mpicpp::comm self = mpicpp::comm::self();
+  out.set_comm(&world);
+  in.set_comm(&self);
+  expected.set_comm(&self);
+  init_test_mesh(2, out);
+  out.allocate();
+  fill_test_soln(out);
+  init_test_mesh(2, expected);
+  expected.allocate();
+  fill_test_soln(expected);
+  dgt::ascii::write_mesh("test_other_ranks", out);
+  world.barrier();
+  dgt::ascii::read_mesh("test_other_ranks.dga", in);
+  ASSERT_EQ(in.owned_leaves().size(), in.leaves().size());
+  expect_same_soln(in, expected);
+  world.barrier();
+  if (world.rank() == 0) {
+    for (dgt::Node* leaf : expected.leaves()) {
+      dgt::Point const pt = leaf->pt();
+      std::string const name =
+        std::to_string(pt.depth) + "_" + std::to_string(pt.ijk.x()) + "_" +
+        std::to_string(pt.ijk.y()) + "_" + std::to_string(pt.ijk.z()) + ".dga";
+      std::filesystem::rename(
+          "test_other_ranks.dga/" + name,
+          "test_other_ranks.dga/" + std::to_string(leaf->block.id()) + ".dga");
+    }
+  }
+  world.barrier();
+  dgt::Mesh legacy;
+  legacy.set_comm(&self);
+  dgt::ascii::read_mesh("test_other_ranks.dga", legacy);
+  expect_same_soln(legacy, expected);
+}
+
+TEST(file, vtk_appended_raw) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  init_test_mesh(2, mesh);
+  mesh.allocate();
+  dgt::Block const& block = mesh.leaves()[0]->block;
+  dgt::vtk::VizView<double> var;
+  Kokkos::resize(var, 16, 1);
+  for (int i = 0; i < 16; ++i) {
+    var.h_view(i, 0) = double(i);
+  }
+  var.modify_host();
+  std::stringstream stream;
+  dgt::vtk::AppendedData appended;
+  std::filesystem::path const path =
+    "test_appended_" + std::to_string(world.rank()) + ".vtr";
+  dgt::vtk::write_vtr_start(stream, block, 0., 0, appended);
+  dgt::vtk::write_field(stream, "var", var, appended);
+  dgt::vtk::write_vtr_end(path, stream, appended);
+  ASSERT_EQ(appended.arrays.size(), 4);
+  std::ifstream file(path, std::ios::binary);
+  std::string const contents(
+      (std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+  std::string const start = "<AppendedData encoding=\"raw\">\n_";
+  std::string const end = "\n</AppendedData>\n</VTKFile>\n";
+  std::size_t const data_pos = contents.find(start);
+  ASSERT_NE(data_pos, std::string::npos);
+  ASSERT_EQ(contents.find("format=\"binary\""), std::string::npos);
+  ASSERT_NE(contents.find("offset=\"0\""), std::string::npos);
+  std::size_t const nbytes = contents.size() - (data_pos + start.size()) - end.size();
+  ASSERT_EQ(nbytes, appended.nbytes);
+  ASSERT_EQ(contents.substr(contents.size() - end.size()), end);
+}
+
+static std::string write_test_array(dgt::vtk::Compression const& compression) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  init_test_mesh(2, mesh);
+  mesh.allocate();
+  dgt::vtk::VizView<double> var;
+  Kokkos::resize(var, 100, 1);
+  for (int i = 0; i < 100; ++i) {
+    var.h_view(i, 0) = double(i);
+  }
+  var.modify_host();
+  std::stringstream stream;
+  dgt::vtk::AppendedData appended;
+  appended.compression = compression;
+  dgt::vtk::write_vtr_start(stream, mesh.leaves()[0]->block, 0., 0, appended);
+  dgt::vtk::write_field(stream, "var", var, appended);
+  return appended.arrays.back();
+}
+
+TEST(file, vtk_chunked_compression) {
+  dgt::vtk::Compression compression;
+  compression.block_size = 128;
+  compression.nthreads = 4;
+  std::string const array = write_test_array(compression);
+  std::uint64_t header[3];
+  std::memcpy(header, array.data(), sizeof(header));
+  ASSERT_EQ(header[0], 7);
+  ASSERT_EQ(header[1], 128);
+  ASSERT_EQ(header[2], 800 % 128);
+  std::vector<std::uint64_t> sizes(header[0]);
+  std::memcpy(sizes.data(), array.data() + sizeof(header), sizes.size() * sizeof(std::uint64_t));
+  std::size_t offset = sizeof(header) + sizes.size() * sizeof(std::uint64_t);
+  std::vector<double> values(100);
+  char* out = reinterpret_cast<char*>(values.data());
+  for (std::uint64_t b = 0; b < header[0]; ++b) {
+    uLongf dest_bytes = 128;
+    int const ret = ::uncompress(
+        reinterpret_cast<Bytef*>(out + b * 128), &dest_bytes,
+        reinterpret_cast<Bytef const*>(array.data() + offset), sizes[b]);
+    ASSERT_EQ(ret, Z_OK);
+    offset += sizes[b];
+  }
+  ASSERT_EQ(offset, array.size());
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(values[i], double(i));
+  }
+}
+
+TEST(file, vtk_uncompressed) {
+  dgt::vtk::Compression compression;
+  compression.enabled = false;
+  std::string const array = write_test_array(compression);
+  std::uint64_t nbytes;
+  std::memcpy(&nbytes, array.data(), sizeof(nbytes));
+  ASSERT_EQ(nbytes, 800);
+  ASSERT_EQ(array.size(), sizeof(nbytes) + 800);
+  double value;
+  std::memcpy(&value, array.data() + sizeof(nbytes) + 99 * sizeof(double), sizeof(double));
+  ASSERT_EQ(value, 99.);
+}
+
+TEST(file, vtu_per_rank) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  init_test_mesh(2, mesh);
+  mesh.allocate();
+  std::vector<dgt::Block const*> blocks;
+  std::vector<dgt::vtk::VizView<double>> fields;
+  int ncells = 0;
+  for (dgt::Node* leaf : mesh.owned_leaves()) {
+    blocks.push_back(&leaf->block);
+    dgt::vtk::VizView<double> var;
+    Kokkos::resize(var, 16, 1);
+    var.modify_host();
+    fields.push_back(var);
+    ncells += 16;
+  }
+  dgt::vtk::VtuPiece piece;
+  dgt::vtk::add_vtu_blocks(piece, 2, blocks);
+  dgt::vtk::add_vtu_field(piece, "var", fields);
+  ASSERT_EQ(piece.ncells, ncells);
+  ASSERT_EQ(piece.npoints, 25 * int(blocks.size()));
+  ASSERT_EQ(piece.arrays.size(), 5);
+  dgt::vtk::VtuFile file;
+  dgt::vtk::gather_vtu(&world, 1, piece, file);
+  ASSERT_EQ(file.ngroups, 1);
+  ASSERT_EQ(file.group, 0);
+  ASSERT_EQ(file.writer, world.rank() == 0);
+  dgt::vtk::write_vtu("test_vtu_", file, 0., 0);
+  if (file.writer) {
+    ASSERT_TRUE(std::filesystem::exists("test_vtu_0.vtu"));
+    ASSERT_EQ(file.pieces.find("<Piece"), 0);
+  }
+  dgt::vtk::gather_vtu(&world, world.size(), piece, file);
+  ASSERT_EQ(file.ngroups, world.size());
+  ASSERT_EQ(file.group, world.rank());
+  ASSERT_TRUE(file.writer);
+  std::vector<int> group_sizes(4, 0);
+  for (int rank = 0; rank < 10; ++rank) {
+    int const group = dgt::vtk::get_vtu_group(rank, 10, 4);
+    ASSERT_GE(group, 0);
+    ASSERT_LT(group, 4);
+    group_sizes[group]++;
+  }
+  for (int const size : group_sizes) {
+    ASSERT_GE(size, 2);
+    ASSERT_LE(size, 3);
+  }
+}
+
+TEST(file, vtu_averages_float) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  init_test_mesh(2, mesh);
+  mesh.allocate();
+  std::vector<dgt::Block const*> blocks;
+  std::vector<dgt::vtk::VizView<float>> fields;
+  for (dgt::Node* leaf : mesh.owned_leaves()) {
+    blocks.push_back(&leaf->block);
+    dgt::vtk::VizView<float> var;
+    Kokkos::resize(var, 4, 1);
+    var.modify_host();
+    fields.push_back(var);
+  }
+  dgt::vtk::VtuPiece piece;
+  dgt::vtk::add_vtu_blocks(piece, 2, blocks, true);
+  dgt::vtk::add_vtu_field(piece, "var", fields);
+  ASSERT_EQ(piece.ncells, 4 * int(blocks.size()));
+  ASSERT_EQ(piece.arrays.back().type, "Float32");
+}
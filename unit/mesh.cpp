@@ -2,7 +2,12 @@
 
 #include "p3a_for_each.hpp"
 
+#include "dgt_error.hpp"
 #include "dgt_mesh.hpp"
+#include "dgt_interp.hpp"
+#include "dgt_reduce.hpp"
+#include "dgt_trace.hpp"
+#include "dgt_vector.hpp"
 
 TEST(mesh, init_1D) {
   dgt::Mesh mesh;
@@ -93,3 +98,158 @@ TEST(mesh, allocate) {
   mesh.rebuild();
   mesh.allocate();
 }
+
+TEST(mesh, pack) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  mesh.set_domain({p3a::vector3<double>(0,0,0), p3a::vector3<double>(1,1,0)});
+  mesh.set_cell_grid({2,2,0});
+  mesh.set_nsoln(2);
+  mesh.set_nmodal_eq(5);
+  mesh.set_nflux_eq(5);
+  mesh.init({2,2,0}, 1, true);
+  mesh.rebuild();
+  mesh.allocate();
+  dgt::BlockPack const& pack = mesh.pack();
+  ASSERT_EQ(pack.nblocks(), int(mesh.owned_leaves().size()));
+  ASSERT_EQ(pack.nsoln(), 2);
+  ASSERT_EQ(pack.cell_grid().extents(), p3a::vector3<int>(2,2,1));
+  for (dgt::Node* leaf : mesh.owned_leaves()) {
+    Kokkos::deep_copy(leaf->block.soln(0), 1.);
+  }
+  dgt::View<int*> count("count", 1);
+  auto f = [=] P3A_DEVICE (int const b, p3a::vector3<int> const& cell_ijk) {
+    int const cell = pack.cell_grid().index(cell_ijk);
+    if (pack.soln(b, 0)(cell, 0, 0) == 1.) Kokkos::atomic_add(&count(0), 1);
+  };
+  dgt::for_each_block_cell(p3a::execution::par, pack, f);
+  dgt::HView<int*> host_count = Kokkos::create_mirror_view(count);
+  Kokkos::deep_copy(host_count, count);
+  ASSERT_EQ(host_count(0), 4 * pack.nblocks());
+}
+
+TEST(mesh, error_flag) {
+  dgt::ErrorFlag error;
+  error.init();
+  ASSERT_EQ(error.check().code, 0);
+  auto f = [=] P3A_HOST_DEVICE (int const i) {
+    if (i % 7 == 3) error.raise(2, 5, i / 10, i);
+  };
+  p3a::for_each(p3a::execution::par,
+      p3a::counting_iterator(0), p3a::counting_iterator(100), f);
+  dgt::ErrorRecord const record = error.check();
+  ASSERT_EQ(record.code, 2);
+  ASSERT_EQ(record.kernel, 5);
+  ASSERT_EQ(record.cell % 7, 3);
+  ASSERT_EQ(record.block, record.cell / 10);
+  error.reset();
+  ASSERT_EQ(error.check().code, 0);
+}
+
+TEST(mesh, reduce) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  mesh.set_domain({p3a::vector3<double>(0,0,0), p3a::vector3<double>(1,1,0)});
+  mesh.set_cell_grid({2,2,0});
+  mesh.set_nsoln(1);
+  mesh.set_nmodal_eq(1);
+  mesh.set_nflux_eq(1);
+  mesh.init({2,2,0}, 0, true);
+  mesh.rebuild();
+  mesh.allocate();
+  dgt::BlockPack const& pack = mesh.pack();
+  dgt::ReduceValues const identity = dgt::make_reduce_values(1, 2);
+  auto f = [=] P3A_HOST_DEVICE (
+      int const b, p3a::vector3<int> const& cell_ijk, dgt::ReduceValues& r) {
+    int const cell = pack.cell_grid().index(cell_ijk);
+    r.vals[0] = p3a::min(r.vals[0], double(cell + 1));
+    r.vals[1] += 1.;
+    r.vals[2] += pack.block(b).cell_detJ;
+  };
+  dgt::ReduceValues const local =
+    dgt::reduce_block_cells(p3a::execution::par, pack, identity, f);
+  dgt::GlobalReduce global;
+  global.start(&world, local);
+  ASSERT_TRUE(global.pending());
+  dgt::ReduceValues const result = global.wait();
+  ASSERT_FALSE(global.pending());
+  ASSERT_EQ(result.vals[0], 1.);
+  ASSERT_EQ(result.vals[1], 16.);
+  ASSERT_NEAR(result.vals[2], 0.25, 1.e-14);
+}
+
+TEST(mesh, vector) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  mesh.set_domain({p3a::vector3<double>(0,0,0), p3a::vector3<double>(1,1,0)});
+  mesh.set_cell_grid({2,2,0});
+  mesh.set_nsoln(3);
+  mesh.set_nmodal_eq(1);
+  mesh.set_nflux_eq(1);
+  mesh.init({2,2,0}, 0, true);
+  mesh.rebuild();
+  mesh.allocate();
+  for (dgt::Node* leaf : mesh.owned_leaves()) {
+    Kokkos::deep_copy(leaf->block.soln(0), 1.);
+    Kokkos::deep_copy(leaf->block.soln(1), -2.);
+  }
+  dgt::MeshVector const x(mesh, 0);
+  dgt::MeshVector const y(mesh, 1);
+  dgt::MeshVector const r(mesh, 2);
+  dgt::axpby(r, 2., x, 3., y);
+  ASSERT_EQ(dgt::norm_inf(r), 4.);
+  ASSERT_EQ(dgt::norm_1(r), 64.);
+  ASSERT_EQ(dgt::dot(r, x), -64.);
+  ASSERT_EQ(dgt::norm_2(r), 16.);
+  dgt::combine(r, {1., 2., 0.5}, {x, y, r});
+  ASSERT_EQ(dgt::dot(r, x), -80.);
+  ASSERT_THROW((void)dgt::MeshVector(mesh, 3), std::runtime_error);
+}
+
+TEST(mesh, traces) {
+  dgt::Mesh mesh;
+  mpicpp::comm world = mpicpp::comm::world();
+  mesh.set_comm(&world);
+  mesh.set_domain({p3a::vector3<double>(0,0,0), p3a::vector3<double>(1,1,0)});
+  mesh.set_cell_grid({2,2,0});
+  mesh.set_nsoln(1);
+  mesh.set_nmodal_eq(2);
+  mesh.set_nflux_eq(2);
+  dgt::add_trace_field(mesh, 2);
+  mesh.init({2,2,0}, 2, true);
+  mesh.rebuild();
+  mesh.allocate();
+  for (dgt::Node* leaf : mesh.owned_leaves()) {
+    ASSERT_TRUE(dgt::has_traces(leaf->block));
+    Kokkos::deep_copy(leaf->block.soln(0), 1.);
+  }
+  dgt::compute_traces(mesh, 0);
+  dgt::BlockPack const& pack = mesh.pack();
+  dgt::Basis const b = mesh.basis();
+  int const npts = dgt::num_pts(1, 2);
+  dgt::View<int*> count("count", 1);
+  auto f = [=] P3A_DEVICE (int const block, p3a::vector3<int> const& cell_ijk) {
+    int const cell = pack.cell_grid().index(cell_ijk);
+    dgt::View<double***> const U = pack.soln(block, 0);
+    for (int axis = 0; axis < 2; ++axis) {
+      for (int dir = 0; dir < dgt::ndirs; ++dir) {
+        for (int pt = 0; pt < npts; ++pt) {
+          for (int eq = 0; eq < 2; ++eq) {
+            int const comp = dgt::get_trace_comp(axis, dir, pt, eq, npts, 2);
+            double const val = dgt::interp_scalar_side(U, b, cell, axis, dir, pt, eq);
+            if (std::abs(pack.trace(block)(cell, comp) - val) > 1.e-14) {
+              Kokkos::atomic_add(&count(0), 1);
+            }
+          }
+        }
+      }
+    }
+  };
+  dgt::for_each_block_cell(p3a::execution::par, pack, f);
+  dgt::HView<int*> host_count = Kokkos::create_mirror_view(count);
+  Kokkos::deep_copy(host_count, count);
+  ASSERT_EQ(host_count(0), 0);
+}
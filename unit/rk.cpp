@@ -0,0 +1,42 @@
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "dgt_rk.hpp"
+
+static double integrate(dgt::RKScheme const& scheme, double lambda, int nsteps) {
+  double const dt = 1./nsteps;
+  double u[dgt::max_rk_registers] = {1., 0.};
+  for (int step = 0; step < nsteps; ++step) {
+    for (dgt::RKStage const& stage : scheme.stages) {
+      u[stage.to] = u[stage.from] + stage.dt * dt * lambda * u[stage.from];
+      if (!stage.combine) continue;
+      double const u0 = u[0];
+      double const u1 = u[1];
+      u[0] = stage.weights[0][0] * u0 + stage.weights[0][1] * u1;
+      u[1] = stage.weights[1][0] * u0 + stage.weights[1][1] * u1;
+    }
+  }
+  return u[0];
+}
+
+static void test_order(std::string const& name) {
+  dgt::RKScheme const scheme = dgt::get_rk_scheme(name);
+  double const lambda = -1.;
+  double const exact = std::exp(lambda);
+  double const e1 = std::abs(integrate(scheme, lambda, 20) - exact);
+  double const e2 = std::abs(integrate(scheme, lambda, 40) - exact);
+  double const rate = std::log2(e1/e2);
+  EXPECT_NEAR(rate, scheme.order, 0.1);
+  EXPECT_LE(scheme.nregisters, dgt::max_rk_registers);
+}
+
+TEST(rk, ssprk1) { test_order("ssprk1"); }
+TEST(rk, ssprk2) { test_order("ssprk2"); }
+TEST(rk, ssprk3) { test_order("ssprk3"); }
+TEST(rk, ssprk52) { test_order("ssprk52"); }
+TEST(rk, ssprk104) { test_order("ssprk104"); }
+
+TEST(rk, unknown_scheme) {
+  EXPECT_THROW((void)dgt::get_rk_scheme("rk4"), std::runtime_error);
+}
@@ -2,6 +2,7 @@
 
 #include "p3a_for_each.hpp"
 
+#include "dgt_amr.hpp"
 #include "dgt_grid.hpp"
 #include "dgt_tree.hpp"
 
@@ -106,3 +107,28 @@ TEST(tree, move_3D) {
   ASSERT_EQ(out1, nullptr);
   ASSERT_EQ(out2, nullptr);
 }
+
+TEST(tree, encode_decode_3D) {
+  dgt::Tree tree;
+  tree.init(p3a::grid3(3,2,1));
+  std::vector<dgt::Node*> leaves = dgt::collect_leaves(tree);
+  dgt::refine(tree.dim(), leaves[1]);
+  leaves = dgt::collect_leaves(tree);
+  dgt::refine(tree.dim(), leaves.back());
+  leaves = dgt::collect_leaves(tree);
+  std::vector<std::uint8_t> const bits = dgt::encode_tree(tree);
+  ASSERT_LT(bits.size(), leaves.size() * sizeof(dgt::Point));
+  dgt::Tree decoded;
+  decoded.init(p3a::grid3(3,2,1));
+  dgt::decode_tree(decoded, bits);
+  std::vector<dgt::Node*> const decoded_leaves = dgt::collect_leaves(decoded);
+  ASSERT_EQ(decoded_leaves.size(), leaves.size());
+  for (std::size_t i = 0; i < leaves.size(); ++i) {
+    ASSERT_EQ(decoded_leaves[i]->pt(), leaves[i]->pt());
+  }
+  std::vector<std::uint8_t> padded = bits;
+  padded.push_back(0);
+  dgt::Tree rejected;
+  rejected.init(p3a::grid3(3,2,1));
+  ASSERT_THROW(dgt::decode_tree(rejected, padded), std::runtime_error);
+}